@@ -0,0 +1,496 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Headless simulation benchmark.
+ * Loads every MAPnn found in the wads, runs G_act() as fast as possible
+ * for a fixed number of ticks and reports tick rate, per-tick latency
+ * percentiles and peak entity counts. Built with stub render and sound.
+ * With -threads N the same run is repeated on N worlds at once, each must
+ * end with the same hash as the single threaded one.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h> // exit malloc qsort
+#include <stdint.h> // uint32_t uint64_t
+#include <assert.h>
+#include <time.h> // clock_gettime
+#include <pthread.h>
+#include "system.h"
+#include "input.h"
+
+#include "player.h" // pl1_keys pl2_keys PL_reset
+#include "monster.h" // nomon
+#include "error.h" // logo
+#include "world.h" // W_alloc W_use mn wp dot sm fx it pl1 pl2
+
+#include "files.h" // F_addwad F_initwads F_findres
+#include "args.h" // ARG_parse
+#include "game.h" // G_init G_start G_act
+#include "sound.h" // S_init S_done
+#include "music.h" // MUS_init MUS_done
+#include "render.h" // R_init R_done
+#include "demo.h" // DEM_args DEM_timedemo DEM_stat DEM_stop
+#include "job.h" // JOB_args
+#include "metrics.h" // MT_args
+
+static dword ticks = 2000;
+static byte map = 0;
+static byte twoplayers = 0;
+static byte deathmatch = 0;
+static byte idle = 0;
+static dword threads = 1;
+
+static const cfg_t arg[] = {
+  {"file", NULL, Y_FILES},
+  {"mon", &nomon, Y_SW_OFF},
+  {"ticks", &ticks, Y_DWORD},
+  {"map", &map, Y_BYTE},
+  {"2pl", &twoplayers, Y_SW_ON},
+  {"dm", &deathmatch, Y_SW_ON},
+  {"idle", &idle, Y_SW_ON},
+  {"threads", &threads, Y_DWORD},
+  {NULL, NULL, 0} // end
+};
+
+typedef struct bench_t {
+  int ticks;
+  uint64_t total, p50, p99, worst;
+  int nmn, nwp, ndot, nsm, nfx; // peak live counts
+  uint32_t hash;
+} bench_t;
+
+typedef struct worker_t {
+  pthread_t id;
+  uint64_t total; // ns spent in G_act
+  int ticks;
+  uint32_t hash;
+  int ok;
+} worker_t;
+
+/* map loading goes through shared wad stream and resource cache */
+static pthread_mutex_t load_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* --- error.h --- */
+
+void logo (const char *s, ...) {
+  // be quiet, only benchmark results go to stdout
+}
+
+void logo_gas (int cur, int all) {
+  // stub
+}
+
+void ERR_failinit (char *s, ...) {
+  va_list ap;
+  va_start(ap, s);
+  vfprintf(stderr, s, ap);
+  va_end(ap);
+  fputs("\n", stderr);
+  exit(1);
+}
+
+void ERR_fatal (char *s, ...) {
+  va_list ap;
+  fputs("\nCRITICAL ERROR:\n", stderr);
+  va_start(ap, s);
+  vfprintf(stderr, s, ap);
+  va_end(ap);
+  fputs("\n", stderr);
+  exit(1);
+}
+
+void ERR_quit (void) {
+  // stub
+}
+
+/* --- system.h --- */
+
+int Y_set_videomode_opengl (int w, int h, int fullscreen) {
+  return 0;
+}
+
+int Y_set_videomode_software (int w, int h, int fullscreen) {
+  return 0;
+}
+
+const videomode_t *Y_get_videomode_list_opengl (int fullscreen) {
+  return NULL;
+}
+
+const videomode_t *Y_get_videomode_list_software (int fullscreen) {
+  return NULL;
+}
+
+void Y_get_videomode (int *w, int *h) {
+  *w = 0;
+  *h = 0;
+}
+
+int Y_videomode_setted (void) {
+  return 0;
+}
+
+void Y_unset_videomode (void) {
+  // stub
+}
+
+void Y_set_fullscreen (int yes) {
+  // stub
+}
+
+int Y_get_fullscreen (void) {
+  return 0;
+}
+
+void Y_swap_buffers (void) {
+  // stub
+}
+
+void Y_get_buffer (byte **buf, int *w, int *h, int *pitch) {
+  *buf = NULL;
+  *w = 0;
+  *h = 0;
+  *pitch = 0;
+}
+
+void Y_set_vga_palette (byte *vgapal) {
+  // stub
+}
+
+void Y_repaint_rect (int x, int y, int w, int h) {
+  // stub
+}
+
+void Y_repaint (void) {
+  // stub
+}
+
+void Y_enable_text_input (void) {
+  // stub
+}
+
+void Y_disable_text_input (void) {
+  // stub
+}
+
+dword Y_get_ticks (void) {
+  return 0;
+}
+
+void Y_delay (dword ms) {
+  // stub
+}
+
+/* --- bench --- */
+
+static uint64_t nanotime (void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int cmp_time (const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static uint32_t mix (uint32_t h, int v) {
+  h = (h ^ (uint32_t)v) * 16777619;
+  return h;
+}
+
+static uint32_t hash_move (int x, int y, int xv, int yv, int t) {
+  uint32_t h = 2166136261u;
+  h = mix(h, x);
+  h = mix(h, y);
+  h = mix(h, xv);
+  h = mix(h, yv);
+  h = mix(h, t);
+  return h;
+}
+
+static uint32_t hash_obj (const obj_t *o, int t) {
+  return hash_move(o->x, o->y, o->xv, o->yv, t);
+}
+
+/* order independent so slot allocation policy does not affect it */
+static uint32_t hash_world (void) {
+  int i;
+  uint32_t h = 0;
+  for (i = 0; i < MAXMN; i++) {
+    if (mn[i].t) {
+      h += hash_obj(&mn[i].o, mn[i].t << 8 | mn[i].st) ^ (uint32_t)mnc[i].life;
+    }
+  }
+  for (i = 0; i < MAXWPN; i++) {
+    if (wp[i].t) {
+      h += hash_obj(&wp[i].o, wp[i].t);
+    }
+  }
+  for (i = 0; i < MAXDOT; i++) {
+    if (dot.t[i]) {
+      h += hash_move(dot.x[i], dot.y[i], dot.xv[i], dot.yv[i], dot.t[i]);
+    }
+  }
+  for (i = 0; i < MAXITEM; i++) {
+    if (it[i].t) {
+      h += hash_obj(&it[i].o, it[i].t);
+    }
+  }
+  for (i = 0; i < MAXSMOK; i++) {
+    if (sm[i].t) {
+      h += mix(mix(mix(2166136261u, sm[i].x), sm[i].y), sm[i].t);
+    }
+  }
+  for (i = 0; i < MAXFX; i++) {
+    if (fx[i].t) {
+      h += mix(mix(mix(2166136261u, fx[i].x), fx[i].y), fx[i].t);
+    }
+  }
+  h += hash_obj(&pl1.o, pl1.st) ^ (uint32_t)pl1.life;
+  if (_2pl) {
+    h += hash_obj(&pl2.o, pl2.st) ^ (uint32_t)pl2.life;
+  }
+  return h;
+}
+
+static void count_live (bench_t *b) {
+  int i, n;
+  for (i = n = 0; i < MAXMN; i++) n += mn[i].t != 0;
+  b->nmn = max(b->nmn, n);
+  for (i = n = 0; i < MAXWPN; i++) n += wp[i].t != 0;
+  b->nwp = max(b->nwp, n);
+  for (i = n = 0; i < MAXDOT; i++) n += dot.t[i] != 0;
+  b->ndot = max(b->ndot, n);
+  for (i = n = 0; i < MAXSMOK; i++) n += sm[i].t != 0;
+  b->nsm = max(b->nsm, n);
+  for (i = n = 0; i < MAXFX; i++) n += fx[i].t != 0;
+  b->nfx = max(b->nfx, n);
+}
+
+/* scripted input: keeps players moving and shooting so every subsystem works */
+static void autoplay (const plkeys_t *p, int t) {
+  I_press(p->kf, 1);
+  I_press(p->kr, (t / 40) % 2 == 0);
+  I_press(p->kl, (t / 40) % 2 == 1);
+  I_press(p->kj, t % 25 < 3);
+  I_press(p->kwr, t % 200 == 0);
+  I_press(p->kp, t % 50 == 0);
+}
+
+static void run_map (int n, bench_t *b, uint64_t *times) {
+  int i;
+  uint64_t t;
+  pthread_mutex_lock(&load_lock);
+  _2pl = twoplayers || deathmatch;
+  g_dm = deathmatch;
+  g_map = n;
+  PL_reset();
+  G_start();
+  pthread_mutex_unlock(&load_lock);
+  b->ticks = 0;
+  b->total = 0;
+  b->nmn = b->nwp = b->ndot = b->nsm = b->nfx = 0;
+  for (i = 0; i < ticks && g_st == GS_GAME; i++) {
+    if (!idle) {
+      autoplay(&pl1_keys, i);
+      if (_2pl) {
+        autoplay(&pl2_keys, i + 20);
+      }
+    }
+    t = nanotime();
+    G_act();
+    times[i] = nanotime() - t;
+    b->total += times[i];
+    b->ticks += 1;
+    count_live(b);
+  }
+  DEM_stop();
+  b->hash = hash_world();
+  if (b->ticks > 0) {
+    qsort(times, b->ticks, sizeof(times[0]), cmp_time);
+    b->p50 = times[b->ticks * 50 / 100];
+    b->p99 = times[b->ticks * 99 / 100];
+    b->worst = times[b->ticks - 1];
+  } else {
+    b->p50 = b->p99 = b->worst = 0;
+  }
+}
+
+static void print_result (const char *name, const bench_t *b) {
+  double rate = b->total ? b->ticks * 1e9 / b->total : 0;
+  printf("%-6s %7i %10.0f %9.2f %9.2f %9.2f %4i %4i %4i %4i %4i  %08x\n",
+    name, b->ticks, rate, b->p50 / 1e3, b->p99 / 1e3, b->worst / 1e3,
+    b->nmn, b->nwp, b->ndot, b->nsm, b->nfx, (unsigned)b->hash);
+}
+
+static int find_map (int i) {
+  char s[9];
+  sprintf(s, "MAP%02u", (word)i);
+  return (map == 0 || map == i) && F_findres(s) != -1;
+}
+
+static void run_all (bench_t *all, uint64_t *times, int print) {
+  int i;
+  char s[9];
+  bench_t b;
+  all->ticks = 0;
+  all->total = 0;
+  all->nmn = all->nwp = all->ndot = all->nsm = all->nfx = 0;
+  all->hash = 0;
+  all->p50 = all->p99 = all->worst = 0;
+  for (i = 1; i <= 99; i++) {
+    if (find_map(i)) {
+      run_map(i, &b, times);
+      if (print) {
+        sprintf(s, "MAP%02u", (word)i);
+        print_result(s, &b);
+      }
+      all->ticks += b.ticks;
+      all->total += b.total;
+      all->p50 = max(all->p50, b.p50);
+      all->p99 = max(all->p99, b.p99);
+      all->worst = max(all->worst, b.worst);
+      all->nmn = max(all->nmn, b.nmn);
+      all->nwp = max(all->nwp, b.nwp);
+      all->ndot = max(all->ndot, b.ndot);
+      all->nsm = max(all->nsm, b.nsm);
+      all->nfx = max(all->nfx, b.nfx);
+      all->hash = all->hash * 31 + b.hash;
+    }
+  }
+}
+
+static void *worker (void *arg) {
+  worker_t *w = arg;
+  bench_t all;
+  uint64_t *times = malloc(ticks * sizeof(times[0]));
+  world_t *wd = W_alloc();
+  if (times != NULL && wd != NULL) {
+    W_use(wd);
+    run_all(&all, times, 0);
+    w->total = all.total;
+    w->ticks = all.ticks;
+    w->hash = all.hash;
+    w->ok = 1;
+  }
+  W_free(wd);
+  free(times);
+  return NULL;
+}
+
+static void run_threads (uint32_t hash) {
+  int i, n, ticks_all;
+  uint64_t t;
+  worker_t *w = calloc(threads, sizeof(worker_t));
+  if (w == NULL) {
+    ERR_failinit("bench: not enough memory for %u threads", (unsigned)threads);
+  }
+  t = nanotime();
+  for (i = n = 0; i < threads; i++, n++) {
+    if (pthread_create(&w[i].id, NULL, worker, &w[i]) != 0) {
+      break;
+    }
+  }
+  for (i = 0; i < n; i++) {
+    pthread_join(w[i].id, NULL);
+  }
+  t = nanotime() - t;
+  for (i = ticks_all = 0; i < n; i++) {
+    printf("thread %-3i %7i %10.0f  %08x %s\n", i, w[i].ticks,
+      w[i].total ? w[i].ticks * 1e9 / w[i].total : 0.0, (unsigned)w[i].hash,
+      !w[i].ok ? "failed" : w[i].hash == hash ? "ok" : "MISMATCH");
+    ticks_all += w[i].ticks;
+  }
+  printf("%i threads: %.0f ticks/s total\n", n, t ? ticks_all * 1e9 / t : 0.0);
+  free(w);
+}
+
+int main (int argc, char *argv[]) {
+  int i;
+  bench_t all;
+  dem_stat_t st;
+  uint64_t *times;
+  const cfg_t *list[4];
+  // Player 1 defaults
+  pl1_keys.ku = KEY_KP_8;
+  pl1_keys.kd = KEY_KP_5;
+  pl1_keys.kl = KEY_KP_4;
+  pl1_keys.kr = KEY_KP_6;
+  pl1_keys.kf = KEY_PAGEDOWN;
+  pl1_keys.kj = KEY_DELETE;
+  pl1_keys.kwl = KEY_HOME;
+  pl1_keys.kwr = KEY_END;
+  pl1_keys.kp = KEY_KP_8;
+  // Player 2 defaults
+  pl2_keys.ku = KEY_E;
+  pl2_keys.kd = KEY_D;
+  pl2_keys.kl = KEY_S;
+  pl2_keys.kr = KEY_F;
+  pl2_keys.kf = KEY_A;
+  pl2_keys.kj = KEY_Q;
+  pl2_keys.kwl = KEY_1;
+  pl2_keys.kwr = KEY_2;
+  pl2_keys.kp = KEY_E;
+  F_addwad("doom2d.wad");
+  list[0] = arg;
+  list[1] = DEM_args();
+  list[2] = JOB_args();
+  list[3] = MT_args();
+  ARG_parse(argc, argv, 4, list);
+  F_initwads();
+  S_init();
+  MUS_init();
+  R_init();
+  G_init();
+  if (DEM_timedemo()) {
+    for (i = 1; i >= 0; i--) {
+      DEM_stat(i, &st);
+      if (st.frames > 0) {
+        printf("timedemo %-6s %6u ticks  avg %8.3f ms  worst %8.3f ms\n",
+          i ? "render" : "nodraw", (unsigned)st.frames, st.avg, st.worst);
+      }
+    }
+    // end state to check for desync
+    printf("timedemo hash %08x\n", (unsigned)hash_world());
+    return 0;
+  }
+  times = malloc(ticks * sizeof(times[0]));
+  if (times == NULL) {
+    ERR_failinit("bench: not enough memory for %u ticks", (unsigned)ticks);
+  }
+  printf("%-6s %7s %10s %9s %9s %9s %4s %4s %4s %4s %4s  %8s\n",
+    "map", "ticks", "ticks/s", "p50,us", "p99,us", "max,us",
+    "mn", "wp", "dot", "sm", "fx", "hash");
+  for (i = 1; i <= 99 && !find_map(i); i++) {
+    // look for any map to run
+  }
+  if (i > 99) {
+    ERR_failinit("bench: no maps found");
+  }
+  run_all(&all, times, 1);
+  print_result("total", &all);
+  free(times);
+  if (threads > 1) {
+    run_threads(all.hash);
+  }
+  R_done();
+  MUS_done();
+  S_done();
+  return 0;
+}
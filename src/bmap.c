@@ -16,13 +16,14 @@
  */
 
 #include <stdio.h>
+#include <string.h> // memset
+#include <assert.h>
 #include "glob.h"
 #include "view.h"
 #include "bmap.h"
-
-byte fld_need_remap=1;
-
-byte bmap[FLDH/4][FLDW/4];
+#include "world.h"
+#include "live.h" // LV_EACH
+#include "misc.h" // ZT_SOLID Z_unsee
 
 void BM_mark(obj_t *o,byte f) {
   int x,y;
@@ -54,4 +55,206 @@ void BM_remapfld(void)
             if (fld[y][x] == 1 || fld[y][x] == 2)
                 bmap[y/4][x/4]|=BM_WALL;
     fld_need_remap = 0;
+    Z_unsee();
+}
+
+void BM_dirty (int x0, int y0, int x1, int y1) {
+  if (!fld_need_remap) {
+    world->bm_x0 = x0; world->bm_y0 = y0;
+    world->bm_x1 = x1; world->bm_y1 = y1;
+    fld_need_remap = 1;
+  } else {
+    world->bm_x0 = min(world->bm_x0, x0); world->bm_y0 = min(world->bm_y0, y0);
+    world->bm_x1 = max(world->bm_x1, x1); world->bm_y1 = max(world->bm_y1, y1);
+  }
+}
+
+/* recount walls of the bmap cells under the dirty box only */
+static void remapdirty (void) {
+  int x, y, i, j;
+  for (y = world->bm_y0 / 4; y <= world->bm_y1 / 4; y++) {
+    for (x = world->bm_x0 / 4; x <= world->bm_x1 / 4; x++) {
+      bmap[y][x] &= ~BM_WALL;
+      for (j = y * 4; j < y * 4 + 4; j++) {
+        for (i = x * 4; i < x * 4 + 4; i++) {
+          if (fldt[j][i] & ZT_SOLID) {
+            bmap[y][x] |= BM_WALL;
+          }
+        }
+      }
+    }
+  }
+  fld_need_remap = 0;
+  Z_unsee();
+}
+
+static void cover (const obj_t *o, bm_rect_t *r) {
+  r->x0 = max((o->x - o->r) >> 5, 0);
+  r->x1 = min((o->x + o->r) >> 5, FLDW/4 - 1) + 1;
+  r->y0 = max((o->y - o->h) >> 5, 0);
+  r->y1 = min(o->y >> 5, FLDH/4 - 1) + 1;
+  if (r->x0 >= r->x1 || r->y0 >= r->y1) {
+    r->x0 = r->y0 = r->x1 = r->y1 = 0;
+  }
+}
+
+static int same (const bm_rect_t *a, const bm_rect_t *b) {
+  return a->x0 == b->x0 && a->y0 == b->y0 && a->x1 == b->x1 && a->y1 == b->y1;
+}
+
+static void player (const bm_rect_t *r, byte f, int on) {
+  int x, y;
+  for (y = r->y0; y < r->y1; y++) {
+    for (x = r->x0; x < r->x1; x++) {
+      if (on) {
+        bmap[y][x] |= f;
+      } else {
+        bmap[y][x] &= ~f;
+      }
+    }
+  }
+}
+
+/* BM_MONSTER stays while any monster mark covers the cell */
+static void monster (const bm_rect_t *r, int d) {
+  int x, y;
+  for (y = r->y0; y < r->y1; y++) {
+    for (x = r->x0; x < r->x1; x++) {
+      if ((bm_mon[y][x] += d) == 0) {
+        bmap[y][x] &= ~BM_MONSTER;
+      } else {
+        bmap[y][x] |= BM_MONSTER;
+      }
+    }
+  }
+}
+
+void BM_reset (void) {
+  BM_clear(BM_PLR1|BM_PLR2|BM_MONSTER);
+  memset(bm_mon, 0, sizeof(bm_mon));
+  memset(world->bm_mn, 0, sizeof(world->bm_mn));
+  memset(world->bm_pl, 0, sizeof(world->bm_pl));
+}
+
+static void sync_player (player_t *p, int on, int n, byte f) {
+  bm_rect_t r = {0};
+  if (on) {
+    cover(&p->o, &r);
+  }
+  if (!same(&r, &world->bm_pl[n])) {
+    player(&world->bm_pl[n], f, 0);
+    player(&r, f, 1);
+    world->bm_pl[n] = r;
+  }
+}
+
+void BM_sync (void) {
+  int i;
+  bm_rect_t r;
+  bm_rect_t *m;
+  static const bm_rect_t none;
+  if (fld_need_remap) {
+    remapdirty();
+  }
+  sync_player(&pl1, 1, 0, BM_PLR1);
+  sync_player(&pl2, _2pl, 1, BM_PLR2);
+  for (i = 0; i < MAXMN; i++) {
+    m = world->bm_mn[i];
+    if (mn[i].t != 0) {
+      cover(&mn[i].o, &r);
+    } else {
+      r = none;
+    }
+    if (!same(&m[0], &r) || !same(&m[1], &none)) {
+      monster(&m[0], -1);
+      monster(&m[1], -1);
+      monster(&r, 1);
+      m[0] = r;
+      m[1] = none;
+    }
+  }
+}
+
+void BM_moved (int i) {
+  bm_rect_t *m = &world->bm_mn[i][1];
+  assert(i >= 0 && i < MAXMN);
+  monster(m, -1);
+  cover(&mn[i].o, m);
+  monster(m, 1);
+}
+
+/* cells of a pixel box, clamped so nothing falls off the grid */
+static void cells (int x0, int y0, int x1, int y1, bm_rect_t *r) {
+  r->x0 = min(max(x0 >> 5, 0), FLDW/4 - 1);
+  r->x1 = min(max(x1 >> 5, 0), FLDW/4 - 1) + 1;
+  r->y0 = min(max(y0 >> 5, 0), FLDH/4 - 1);
+  r->y1 = min(max(y1 >> 5, 0), FLDH/4 - 1) + 1;
+}
+
+static void grid (const bm_rect_t *r, int i, int on) {
+  int x, y;
+  uint64_t b = 1ULL << (i & 63);
+  for (y = r->y0; y < r->y1; y++) {
+    for (x = r->x0; x < r->x1; x++) {
+      if (on) {
+        world->bm_grid[y][x][i >> 6] |= b;
+      } else {
+        world->bm_grid[y][x][i >> 6] &= ~b;
+      }
+    }
+  }
+}
+
+void BM_regrid (void) {
+  int i;
+  memset(world->bm_grid, 0, sizeof(world->bm_grid));
+  memset(world->bm_cell, 0, sizeof(world->bm_cell));
+  LV_EACH(i, mn_live, MAXMN) {
+    BM_place(i);
+  }
+}
+
+void BM_place (int i) {
+  bm_rect_t r;
+  obj_t *o = &mn[i].o;
+  bm_rect_t *c = &world->bm_cell[i];
+  assert(i >= 0 && i < MAXMN);
+  cells(o->x - o->r, o->y - o->h, o->x + o->r, o->y, &r);
+  if (!same(&r, c)) {
+    grid(c, i, 0);
+    grid(&r, i, 1);
+    *c = r;
+  }
+}
+
+void BM_near (int x0, int y0, int x1, int y1, uint64_t set[BM_MNW]) {
+  int x, y, k;
+  bm_rect_t r;
+  cells(x0, y0, x1, y1, &r);
+  memset(set, 0, BM_MNW * sizeof(set[0]));
+  for (y = r.y0; y < r.y1; y++) {
+    for (x = r.x0; x < r.x1; x++) {
+      for (k = 0; k < BM_MNW; k++) {
+        set[k] |= world->bm_grid[y][x][k];
+      }
+    }
+  }
+}
+
+int BM_pop (uint64_t set[BM_MNW]) {
+  int k, i;
+  for (k = 0; k < BM_MNW; k++) {
+    if (set[k] != 0) {
+#ifdef __GNUC__
+      i = __builtin_ctzll(set[k]);
+#else
+      for (i = 0; !(set[k] >> i & 1); i++) {
+        // lowest bit
+      }
+#endif
+      set[k] &= set[k] - 1;
+      return k * 64 + i;
+    }
+  }
+  return -1;
 }
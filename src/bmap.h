@@ -19,18 +19,40 @@
 #define BMAP_H_INCLUDED
 
 #include "glob.h"
+#include <stdint.h> // uint64_t
 #include "view.h" // obj_t
+#include "monster.h" // MAXMN
 
 #define BM_WALL		1
 #define BM_PLR1		2
 #define BM_PLR2		4
 #define BM_MONSTER	8
 
-extern byte fld_need_remap;
-extern byte bmap[FLDH/4][FLDW/4];
+/* bmap cells x0..x1-1, y0..y1-1, zeroed is empty */
+typedef struct bm_rect_t {
+  short x0, y0, x1, y1;
+} bm_rect_t;
 
 void BM_clear (byte f);
 void BM_mark (obj_t *o, byte f);
 void BM_remapfld (void);
+void BM_dirty (int x0, int y0, int x1, int y1); // fld cells changed, inclusive
+void BM_reset (void); // forget player and monster marks
+void BM_sync (void); // walls in dirty box, players and monsters where they are now
+void BM_moved (int i); // monster i moved, mark it there too until BM_sync
+
+/*
+ * Spatial grid of monster indices in bmap cells, always matches where the
+ * monsters are now. Objects outside the map are kept in border cells.
+ * Queries give a superset of monsters touching a pixel box as a bitset,
+ * take them out in ascending index order like a full scan would go.
+ */
+
+#define BM_MNW ((MAXMN + 63) / 64)
+
+void BM_regrid (void); // all monsters
+void BM_place (int i); // monster i spawned, moved or changed size
+void BM_near (int x0, int y0, int x1, int y1, uint64_t set[BM_MNW]);
+int BM_pop (uint64_t set[BM_MNW]); // lowest index, removed from set, -1 if empty
 
 #endif /* BMAP_H_INCLUDED */
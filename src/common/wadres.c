@@ -24,6 +24,7 @@ static int n_resources;
 static Stream *wads[MAX_WADS];
 static Entry resources[MAX_RESOURCES];
 static Block *blocks[MAX_RESOURCES];
+static long locked; // bytes held by blocks with ref >= 1
 
 static int s_start, s_end;
 
@@ -164,6 +165,9 @@ void *WADRES_lock (int id) {
   if (id >= 0) {
     Block *x = blocks[id];
     if (x) {
+      if (x->ref == 0) {
+        locked += WADRES_getsize(id);
+      }
       x->ref += 1;
       return x->data;
     } else {
@@ -172,6 +176,7 @@ void *WADRES_lock (int id) {
         x->id = id;
         x->ref = 1;
         WADRES_getdata(id, x->data);
+        locked += WADRES_getsize(id);
         blocks[id] = x;
         return x->data;
       }
@@ -189,6 +194,9 @@ void WADRES_unlock (void *data) {
     assert(id >= 0 && id < MAX_RESOURCES);
     x->ref -= 1;
     assert(x->ref >= 0);
+    if (x->ref == 0) {
+      locked -= WADRES_getsize(id);
+    }
 #if 0
     if (x->ref == 0) {
       blocks[id] = NULL;
@@ -203,6 +211,10 @@ int WADRES_locked (int id) {
   return (id >= 0) && (blocks[id] != NULL) && (blocks[id]->ref >= 1);
 }
 
+long WADRES_lockedsize (void) {
+  return locked;
+}
+
 int WADRES_was_locked (int id) {
   assert(id >= -1 && id < MAX_RESOURCES);
   return (id >= 0) && (blocks[id] != NULL) && (blocks[id]->ref >= 0);
@@ -40,5 +40,6 @@ void *WADRES_lock (int id);
 void  WADRES_unlock (void *data);
 int   WADRES_locked (int id);
 int   WADRES_was_locked (int id);
+long  WADRES_lockedsize (void); // bytes in locked resources
 
 #endif /* COMMON_WADRES_H_INCLUDED */
\ No newline at end of file
@@ -52,7 +52,11 @@ int CFG_update_key (const char *key, const char *value, const cfg_t *cfg) {
       case Y_BYTE: *(byte*)p = atoi(value); break;
       case Y_WORD: *(word*)p = atoi(value); break;
       case Y_DWORD: *(dword*)p = atoi(value); break;
-      case Y_STRING: strcpy(p, value); break; // TODO fix this security problem
+      case Y_STRING:
+        assert(entry->n > 0);
+        strncpy(p, value, entry->n - 1);
+        ((char*)p)[entry->n - 1] = 0;
+        break;
       case Y_SW_ON: *(byte*)p = cp866_strcasecmp(value, "on") == 0 ? 1 : 0; break;
       case Y_SW_OFF: *(byte*)p = cp866_strcasecmp(value, "off") == 0 ? 1 : 0; break;
       case Y_FILES: F_addwad(value); break;
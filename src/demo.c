@@ -0,0 +1,258 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "demo.h"
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include "common/streams.h"
+#include "common/files.h"
+#include "input.h" // I_pressed I_press
+#include "game.h" // G_start G_act G_seed
+#include "player.h" // pl1_keys pl2_keys PL_reset
+#include "monster.h" // nomon
+#include "render.h" // R_draw
+#include "view.h" // W_ALPHA
+#include "save.h" // SAVE_save_players SAVE_load_players
+#include "error.h" // logo
+#include "world.h"
+
+/*
+ * File layout:
+ *   "D2DM", version, map, dm, 2pl, nomon, seed, key bindings, players
+ *   per tick: number of keys changed since previous tick, then their codes
+ *   DEM_END after last tick
+ */
+
+#define DEM_VERSION 1
+#define DEM_END 0xFF
+#define DEM_NAMELEN 256
+
+static char recname[DEM_NAMELEN];
+static char playname[DEM_NAMELEN];
+static byte nodraw;
+static dem_stat_t stat[2]; // timedemo passes, indexed by draw
+
+static FILE_Stream h;
+static int recording;
+static int recorded;
+static int playing;
+static long len;
+static byte keys[KEY__LAST + 1];
+
+const cfg_t *DEM_args (void) {
+  static const cfg_t args[] = {
+    { "record", recname, Y_STRING, sizeof(recname) },
+    { "timedemo", playname, Y_STRING, sizeof(playname) },
+    { "nodraw", &nodraw, Y_SW_ON },
+    { NULL, NULL, 0 } // end
+  };
+  return args;
+}
+
+static int *bindings (plkeys_t *p, int i) {
+  int *k[9] = { &p->ku, &p->kd, &p->kl, &p->kr, &p->kf, &p->kj, &p->kwl, &p->kwr, &p->kp };
+  return k[i];
+}
+
+void DEM_start (void) {
+  int i;
+  assert(KEY__LAST < DEM_END);
+  if (recname[0] == 0 || recording || recorded || playing) {
+    return;
+  }
+  if (!FILE_Open(&h, recname, "wb")) {
+    logo("DEM_start: can't create %s\n", recname);
+    recorded = 1;
+    return;
+  }
+  logo("DEM_start: recording %s\n", recname);
+  stream_write("D2DM", 4, 1, &h.base);
+  stream_write16(DEM_VERSION, &h.base);
+  stream_write8(g_map, &h.base);
+  stream_write8(g_dm, &h.base);
+  stream_write8(_2pl, &h.base);
+  stream_write8(nomon, &h.base);
+  stream_write32(G_seed(), &h.base);
+  for (i = 0; i < 9; i++) {
+    stream_write8(*bindings(&pl1_keys, i), &h.base);
+    stream_write8(*bindings(&pl2_keys, i), &h.base);
+  }
+  SAVE_save_players(&h.base);
+  memset(keys, 0, sizeof(keys));
+  recording = 1;
+}
+
+static void record (void) {
+  int i, n;
+  byte d[KEY__LAST + 1];
+  for (i = n = 0; i <= KEY__LAST; i++) {
+    if (keys[i] != I_pressed(i)) {
+      keys[i] = I_pressed(i);
+      d[n++] = i;
+    }
+  }
+  stream_write8(n, &h.base);
+  stream_write(d, 1, n, &h.base);
+}
+
+static int more (void) {
+  long pos = stream_getpos(&h.base);
+  int end = pos >= len || (byte)stream_read8(&h.base) == DEM_END;
+  if (!end) {
+    stream_setpos(&h.base, pos);
+  }
+  return !end;
+}
+
+static void play (void) {
+  int i, n;
+  if (!more()) {
+    playing = 0;
+    return;
+  }
+  n = (byte)stream_read8(&h.base);
+  for (i = 0; i < n; i++) {
+    keys[(byte)stream_read8(&h.base)] ^= 1;
+  }
+  // override whatever comes from the real keyboard
+  for (i = 0; i <= KEY__LAST; i++) {
+    I_press(i, keys[i]);
+  }
+}
+
+void DEM_tick (void) {
+  if (recording) {
+    record();
+  } else if (playing) {
+    play();
+  }
+}
+
+void DEM_stop (void) {
+  if (recording) {
+    stream_write8(DEM_END, &h.base);
+    FILE_Close(&h);
+    recording = 0;
+    recorded = 1;
+    logo("DEM_stop: %s done\n", recname);
+  }
+}
+
+static int begin (void) {
+  int i;
+  char magic[4];
+  int version;
+  dword seed;
+  if (!FILE_Open(&h, playname, "rb")) {
+    logo("DEM_timedemo: can't open %s\n", playname);
+    return 0;
+  }
+  len = stream_getlen(&h.base);
+  if (len < 6) {
+    logo("DEM_timedemo: %s is not a demo\n", playname);
+    FILE_Close(&h);
+    return 0;
+  }
+  stream_read(magic, 4, 1, &h.base);
+  version = stream_read16(&h.base);
+  if (memcmp(magic, "D2DM", 4) != 0 || version != DEM_VERSION) {
+    logo("DEM_timedemo: %s is not a demo or has wrong version\n", playname);
+    FILE_Close(&h);
+    return 0;
+  }
+  g_map = stream_read8(&h.base);
+  g_dm = stream_read8(&h.base);
+  _2pl = stream_read8(&h.base);
+  nomon = stream_read8(&h.base);
+  seed = stream_read32(&h.base);
+  for (i = 0; i < 9; i++) {
+    *bindings(&pl1_keys, i) = (byte)stream_read8(&h.base);
+    *bindings(&pl2_keys, i) = (byte)stream_read8(&h.base);
+  }
+  PL_reset();
+  G_start();
+  SAVE_load_players(&h.base);
+  if (G_seed() != seed) {
+    logo("DEM_timedemo: seed mismatch, playback will desync\n");
+  }
+  memset(keys, 0, sizeof(keys));
+  playing = 1;
+  return 1;
+}
+
+static unsigned long long nanotime (void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  return clock() * (1000000000ULL / CLOCKS_PER_SEC);
+#endif
+}
+
+static int run (int draw) {
+  int frames;
+  unsigned long long t, dt, total, worst;
+  if (!begin()) {
+    return 0;
+  }
+  frames = 0;
+  total = worst = 0;
+  while (more() && g_st == GS_GAME) {
+    t = nanotime();
+    G_act();
+    if (draw) {
+      R_draw(W_ALPHA);
+    }
+    dt = nanotime() - t;
+    total += dt;
+    worst = dt > worst ? dt : worst;
+    frames += 1;
+  }
+  FILE_Close(&h);
+  playing = 0;
+  stat[draw].frames = frames;
+  stat[draw].avg = frames ? total / 1e6 / frames : 0.0;
+  stat[draw].worst = worst / 1e6;
+  logo("timedemo: %s %i frames, avg %.3f ms, worst %.3f ms\n",
+    draw ? "render" : "nodraw", frames, stat[draw].avg, stat[draw].worst);
+  return 1;
+}
+
+int DEM_timedemo (void) {
+  int i, k[2][9];
+  if (playname[0] == 0) {
+    return 0;
+  }
+  // demo header overrides key bindings, keep config intact
+  for (i = 0; i < 9; i++) {
+    k[0][i] = *bindings(&pl1_keys, i);
+    k[1][i] = *bindings(&pl2_keys, i);
+  }
+  memset(stat, 0, sizeof(stat));
+  if (nodraw || run(1)) {
+    run(0);
+  }
+  for (i = 0; i < 9; i++) {
+    *bindings(&pl1_keys, i) = k[0][i];
+    *bindings(&pl2_keys, i) = k[1][i];
+  }
+  return 1;
+}
+
+void DEM_stat (int draw, dem_stat_t *st) {
+  *st = stat[draw != 0];
+}
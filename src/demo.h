@@ -0,0 +1,41 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEMO_H_INCLUDED
+#define DEMO_H_INCLUDED
+
+#include "system.h" // cfg_t
+
+/*
+ * Demo covers one level: recording starts with the first G_start after
+ * -record and ends when the level is left, a game is loaded or a new one
+ * is started from the menu. Only the key state seen by the simulation is
+ * stored, so cheats typed into the menu are not reproduced.
+ */
+
+typedef struct dem_stat_t {
+  dword frames; // 0 when this pass did not run
+  double avg, worst; // ms per tick, G_act plus R_draw when rendering
+} dem_stat_t;
+
+const cfg_t *DEM_args (void);
+
+void DEM_start (void); // G_start: begin recording
+void DEM_tick (void); // G_act: store or replay key state for this tick
+void DEM_stop (void); // finish recording
+int  DEM_timedemo (void); // play -timedemo, returns 0 when not requested
+void DEM_stat (int draw, dem_stat_t *st); // last -timedemo pass with or without R_draw
+
+#endif /* DEMO_H_INCLUDED */
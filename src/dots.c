@@ -21,6 +21,10 @@
 #include "view.h"
 #include "dots.h"
 #include "misc.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
+#include "error.h"
 
 #define MAXINI 50
 #define MAXSR 20
@@ -39,17 +43,21 @@ typedef struct{
   byte c,t;
 }init_t;
 
-dot_t dot[MAXDOT];
+#define bl_r (world->dot_bl_r)
+#define sp_r (world->dot_sp_r)
+#define sr_r (world->dot_sr_r)
+#define ldot (world->dot_last)
 
 static init_t bl_ini[MAXINI],sp_ini[MAXINI];
-static int bl_r,sp_r,sr_r,sxr[MAXSR],syr[MAXSR];
-static int ldot;
+static int sxr[MAXSR],syr[MAXSR];
 
 void DOT_init(void) {
   int i;
 
-  for(i=0;i<MAXDOT;++i) {dot[i].t=0;dot[i].o.r=0;dot[i].o.h=1;}
+  for(i=0;i<MAXDOT;++i) dot.t[i]=0;
+  LV_clear(dot_live,MAXDOT);
   ldot=0;
+  bl_r=sp_r=sr_r=0;
 }
 
 static void incldot(void) {
@@ -60,53 +68,145 @@ void DOT_alloc(void) {
   int i;
 
   for(i=0;i<MAXINI;++i) {
-	bl_ini[i].xv=myrand(BL_XV*2+1)-BL_XV;
-	bl_ini[i].yv=-myrand(BL_YV);
-	bl_ini[i].c=0xB0+myrand(16);
-	bl_ini[i].t=myrand(BL_MAXT-BL_MINT+1)+BL_MINT;
-	sp_ini[i].xv=myrand(SP_V*2+1)-SP_V;
-	sp_ini[i].yv=myrand(SP_V*2+1)-SP_V;
-	sp_ini[i].c=0xA0+myrand(6);
-	sp_ini[i].t=myrand(SP_MAXT-SP_MINT+1)+SP_MINT;
+	bl_ini[i].xv=RND_mod(RND_INIT,BL_XV*2+1)-BL_XV;
+	bl_ini[i].yv=-RND_mod(RND_INIT,BL_YV);
+	bl_ini[i].c=0xB0+RND_mod(RND_INIT,16);
+	bl_ini[i].t=RND_mod(RND_INIT,BL_MAXT-BL_MINT+1)+BL_MINT;
+	sp_ini[i].xv=RND_mod(RND_INIT,SP_V*2+1)-SP_V;
+	sp_ini[i].yv=RND_mod(RND_INIT,SP_V*2+1)-SP_V;
+	sp_ini[i].c=0xA0+RND_mod(RND_INIT,6);
+	sp_ini[i].t=RND_mod(RND_INIT,SP_MAXT-SP_MINT+1)+SP_MINT;
   }
   for(i=0;i<MAXSR;++i) {
-	sxr[i]=myrand(2*2+1)-2;
-	syr[i]=myrand(2*2+1)-2;
+	sxr[i]=RND_mod(RND_INIT,2*2+1)-2;
+	syr[i]=RND_mod(RND_INIT,2*2+1)-2;
   }
   bl_r=sp_r=sr_r=0;
 }
 
-void DOT_act(void) {
+#define CH(v) ((signed char)(v)==(v))
+
+/* no spawns and no random numbers here, only own dots are touched */
+void DOT_move(int chunk) {
+  int i,j,k,i0,n,nl,lo,hi,yv,vx,vy,xs,ys,a,ok;
+  int m[DOT_CHUNK];
+  byte live[DOT_CHUNK],done[DOT_CHUNK];
+  dot_stay_t *s;
+  obj_t o;
+#ifdef SWEEPCHECK
+  obj_t was[DOT_CHUNK];
+  byte fast[DOT_CHUNK];
+  z_env_t e;
+#endif
+
+  i0=chunk*DOT_CHUNK;
+  n=min(DOT_CHUNK,MAXDOT-i0);
+  lo=n;hi=nl=0;
+  for(i=0;i<n;++i) {m[i]=-1;done[i]=0;}
+  for(k=LV_next(dot_live,i0+n,i0);k<i0+n;k=LV_next(dot_live,i0+n,k+1)) {
+    i=k-i0;
+    world->dot_xv[k]=dot.xv[k]+dot.vx[k];
+    world->dot_yv[k]=dot.yv[k]+dot.vy[k];
+#ifdef SWEEPCHECK
+    was[i].x=dot.x[k];was[i].y=dot.y[k];was[i].xv=dot.xv[k];was[i].yv=dot.yv[k];
+    was[i].vx=dot.vx[k];was[i].vy=dot.vy[k];was[i].r=0;was[i].h=1;
+    fast[i]=1;
+#endif
+    s=&world->dot_stay[k];
+    if(s->gen==world->z_envgen && world->dot_env[k].x==dot.x[k] && world->dot_env[k].y==dot.y[k]
+      && s->xv==dot.xv[k] && s->yv==dot.yv[k] && s->vx==dot.vx[k] && s->vy==dot.vy[k]) {
+      // lying still or stuck to a wall, settles the same way every time
+      dot.xv[k]=s->nxv;dot.yv[k]=s->nyv;dot.vx[k]=s->nvx;dot.vy[k]=s->nvy;
+      world->dot_st[k]=s->st;
+      continue;
+    }
+    world->dot_st[k]=0;
+    live[nl++]=i;
+    // Z_open(x,y,0,1) without the call
+    m[i]=(unsigned)dot.x[k]<FLDW*CELW && (unsigned)dot.y[k]<FLDH*CELH?fldo[dot.y[k]/CELH][dot.x[k]/CELW]-2:-1;
+    if(m[i]>=0) {lo=min(lo,i);hi=i+1;}
+  }
+  // Z_movedot in open air, no branches and no conditional stores so that
+  // the compiler does all of them with vector instructions
+  for(i=lo;i<hi;++i) {
+    k=i0+i;
+    yv=dot.yv[k]+1;yv-=yv>MAX_YV;
+    vx=dot.vx[k];vx-=(vx>0)-(vx<0);
+    vy=dot.vy[k];vy-=(vy>0)-(vy<0);
+    xs=dot.xv[k]+vx;ys=yv+vy;
+    a=max(abs(xs),abs(ys));
+    // up to 35 the (ys-1)/7 of the 7 pixel steps is a sum of compares
+    ok=(ys<=35)&(m[i]>=(a+CELW-1)/CELW);
+    done[i]=ok;
+    ok=-ok;
+    dot.x[k]+=xs&ok;
+    dot.y[k]+=(ys-(ys>=8)-(ys>=15)-(ys>=22)-(ys>=29))&ok;
+    dot.yv[k]+=(yv-dot.yv[k])&ok;
+    dot.vx[k]+=(vx-dot.vx[k])&ok;
+    dot.vy[k]+=(vy-dot.vy[k])&ok;
+  }
+  // the rest is near tiles
+  o.r=0;o.h=1;
+  for(j=0;j<nl;++j) if(!done[i=live[j]]) {
+    k=i0+i;
+    o.x=dot.x[k];o.y=dot.y[k];o.xv=dot.xv[k];o.yv=dot.yv[k];o.vx=dot.vx[k];o.vy=dot.vy[k];
+    world->dot_st[k]=Z_movedot(&o,&world->dot_env[k],m[i]);
+#ifdef SWEEPCHECK
+    fast[i]=0;
+#endif
+    s=&world->dot_stay[k];
+    s->gen=0;
+    if(o.x==dot.x[k] && o.y==dot.y[k] && world->dot_env[k].x==o.x && world->dot_env[k].y==o.y
+      && CH(dot.xv[k]) && CH(dot.yv[k]) && CH(dot.vx[k]) && CH(dot.vy[k])
+      && CH(o.xv) && CH(o.yv) && CH(o.vx) && CH(o.vy)) {
+      s->gen=world->z_envgen;
+      s->xv=dot.xv[k];s->yv=dot.yv[k];s->vx=dot.vx[k];s->vy=dot.vy[k];
+      s->nxv=o.xv;s->nyv=o.yv;s->nvx=o.vx;s->nvy=o.vy;
+      s->st=world->dot_st[k];
+    }
+    dot.x[k]=o.x;dot.y[k]=o.y;dot.xv[k]=o.xv;dot.yv[k]=o.yv;dot.vx[k]=o.vx;dot.vy[k]=o.vy;
+  }
+#ifdef SWEEPCHECK
+  // open air pass and dot_stay skip Z_movedot, check them against it
+  for(k=LV_next(dot_live,i0+n,i0);k<i0+n;k=LV_next(dot_live,i0+n,k+1)) if(fast[i=k-i0]) {
+    o=was[i];e=world->dot_env[k];
+    j=Z_movedot(&o,&e,Z_open(o.x,o.y,0,1));
+    if(j!=world->dot_st[k] || o.x!=dot.x[k] || o.y!=dot.y[k] || o.xv!=dot.xv[k] || o.yv!=dot.yv[k]
+      || o.vx!=dot.vx[k] || o.vy!=dot.vy[k])
+      ERR_fatal("DOT_move: dot %d ended at %d,%d st %d, Z_movedot at %d,%d st %d",k,dot.x[k],dot.y[k],world->dot_st[k],o.x,o.y,j);
+  }
+#endif
+}
+
+void DOT_settle(void) {
   int i,s,xv,yv;
 
-  z_dot=1;
-  for(i=0;i<MAXDOT;++i) if(dot[i].t) {
-    xv=dot[i].o.xv+dot[i].o.vx;
-    yv=dot[i].o.yv+dot[i].o.vy;
-    s=Z_moveobj(&dot[i].o);
-    if(dot[i].t<254) --dot[i].t;
-    if(s&(Z_HITWATER|Z_FALLOUT)) {dot[i].t=0;continue;}
+  LV_EACH(i,dot_live,MAXDOT) {
+    xv=world->dot_xv[i];
+    yv=world->dot_yv[i];
+    s=world->dot_st[i];
+    if(dot.t[i]<254) if(!--dot.t[i]) LV_put(dot_live,i,0);
+    if(s&(Z_HITWATER|Z_FALLOUT)) {dot.t[i]=0;LV_put(dot_live,i,0);continue;}
     if(s&Z_HITLAND) {
-      if(!dot[i].o.xv) {
+      if(!dot.xv[i]) {
         if(yv>2) {
-          if(!xv) dot[i].o.vx=(rand()&1)?-1:1;
-          else dot[i].o.vx=Z_sign(dot[i].o.vx);
-          if(rand()%yv==0) dot[i].o.vx*=2;
-          dot[i].o.yv=yv-2;
+          if(!xv) dot.vx[i]=(RND_rand(RND_DOTS)&1)?-1:1;
+          else dot.vx[i]=Z_sign(dot.vx[i]);
+          if(RND_rand(RND_DOTS)%yv==0) dot.vx[i]*=2;
+          dot.yv[i]=yv-2;
         }
       }
-      dot[i].o.xv=0;
-      if(dot[i].t>4 && dot[i].t!=255) dot[i].t=4;
+      dot.xv[i]=0;
+      if(dot.t[i]>4 && dot.t[i]!=255) dot.t[i]=4;
     }
     if(s&Z_HITWALL) {
-      dot[i].o.vx=Z_sign(xv)*2;
-      dot[i].o.yv=Z_sign(dot[i].o.yv);
-      if(dot[i].o.yv>=0) if(rand()&3) --dot[i].o.yv;
-      if(dot[i].o.yv>=0) if(rand()&1) --dot[i].o.yv;
+      dot.vx[i]=Z_sign(xv)*2;
+      dot.yv[i]=Z_sign(dot.yv[i]);
+      if(dot.yv[i]>=0) if(RND_rand(RND_DOTS)&3) --dot.yv[i];
+      if(dot.yv[i]>=0) if(RND_rand(RND_DOTS)&1) --dot.yv[i];
     }
-    if(s&Z_HITCEIL) {dot[i].o.xv=0;dot[i].o.yv=(myrand(100))?-2:0;}
+    if(s&Z_HITCEIL) {dot.xv[i]=0;dot.yv[i]=(RND_mod(RND_DOTS,100))?-2:0;}
   }
-  z_dot=0;
 }
 
 void DOT_add(int x,int y,char xv,char yv,byte c,byte t) {
@@ -114,10 +214,11 @@ void DOT_add(int x,int y,char xv,char yv,byte c,byte t) {
 
   if(!Z_canfit(x,y,0,1)) return;
   i=ldot;
-  dot[i].o.x=x;dot[i].o.y=y;
-  dot[i].o.xv=xv;dot[i].o.yv=yv;
-  dot[i].c=c;dot[i].t=t;
-  dot[i].o.vx=dot[i].o.vy=0;
+  dot.x[i]=x;dot.y[i]=y;
+  dot.xv[i]=xv;dot.yv[i]=yv;
+  dot.c[i]=c;dot.t[i]=t;
+  LV_put(dot_live,i,t);
+  dot.vx[i]=dot.vy[i]=0;
   incldot();
 }
 
@@ -128,12 +229,13 @@ void DOT_blood(int x,int y,int xv,int yv,int n) {
     dx=x+sxr[sr_r];dy=y+syr[sr_r];
     if(!Z_canfit(x,y,0,1)) continue;
     i=ldot;
-	dot[i].o.x=dx;dot[i].o.y=dy;
-	dot[i].o.xv=bl_ini[bl_r].xv+Z_dec(xv,3);
-	dot[i].o.yv=bl_ini[bl_r].yv+Z_dec(yv,3)-3;
-	dot[i].c=bl_ini[bl_r].c;
-	dot[i].t=255;
-	dot[i].o.vx=dot[i].o.vy=0;
+	dot.x[i]=dx;dot.y[i]=dy;
+	dot.xv[i]=bl_ini[bl_r].xv+Z_dec(xv,3);
+	dot.yv[i]=bl_ini[bl_r].yv+Z_dec(yv,3)-3;
+	dot.c[i]=bl_ini[bl_r].c;
+	dot.t[i]=255;
+	LV_put(dot_live,i,255);
+	dot.vx[i]=dot.vy[i]=0;
 	if(++bl_r>=MAXINI) bl_r=0;
 	if(++sr_r>=MAXSR) sr_r=0;
     incldot();
@@ -147,12 +249,13 @@ void DOT_spark(int x,int y,int xv,int yv,int n) {
     dx=x+sxr[sr_r];dy=y+syr[sr_r];
     if(!Z_canfit(x,y,0,1)) continue;
     i=ldot;
-	dot[i].o.x=dx;dot[i].o.y=dy;
-	dot[i].o.xv=sp_ini[sp_r].xv-xv/4;
-	dot[i].o.yv=sp_ini[sp_r].yv-yv/4;
-	dot[i].c=sp_ini[sp_r].c;
-	dot[i].t=sp_ini[sp_r].t;
-	dot[i].o.vx=dot[i].o.vy=0;
+	dot.x[i]=dx;dot.y[i]=dy;
+	dot.xv[i]=sp_ini[sp_r].xv-xv/4;
+	dot.yv[i]=sp_ini[sp_r].yv-yv/4;
+	dot.c[i]=sp_ini[sp_r].c;
+	dot.t[i]=sp_ini[sp_r].t;
+	LV_put(dot_live,i,dot.t[i]);
+	dot.vx[i]=dot.vy[i]=0;
 	if(++sp_r>=MAXINI) sp_r=0;
 	if(++sr_r>=MAXSR) sr_r=0;
     incldot();
@@ -169,12 +272,13 @@ void DOT_water(int x,int y,int xv,int yv,int n,int c) {
     dx=x+sxr[sr_r];dy=y+syr[sr_r];
     if(!Z_canfit(x,y,0,1)) continue;
     i=ldot;
-	dot[i].o.x=dx;dot[i].o.y=dy;
-	dot[i].o.xv=bl_ini[bl_r].xv-Z_dec(xv,3);
-	dot[i].o.yv=bl_ini[bl_r].yv-abs(yv);
-	dot[i].c=bl_ini[bl_r].c-0xB0+c;
-	dot[i].t=254;
-	dot[i].o.vx=dot[i].o.vy=0;
+	dot.x[i]=dx;dot.y[i]=dy;
+	dot.xv[i]=bl_ini[bl_r].xv-Z_dec(xv,3);
+	dot.yv[i]=bl_ini[bl_r].yv-abs(yv);
+	dot.c[i]=bl_ini[bl_r].c-0xB0+c;
+	dot.t[i]=254;
+	LV_put(dot_live,i,254);
+	dot.vx[i]=dot.vy[i]=0;
 	if(++bl_r>=MAXINI) bl_r=0;
 	if(++sr_r>=MAXSR) sr_r=0;
     incldot();
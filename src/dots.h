@@ -19,20 +19,34 @@
 #define DOTS_H_INCLUDED
 
 #include "glob.h"
-#include "view.h" // obj_t
 
-#define MAXDOT 400
+#define MAXDOT (400 * POOL_SCALE)
+#define DOT_CHUNK 64 // dots moved by one DOT_move
+#define DOT_CHUNKS ((MAXDOT + DOT_CHUNK - 1) / DOT_CHUNK)
 
+/* one array per field so DOT_move can run over a chunk at once,
+   every dot is 0 wide and 1 high */
 typedef struct {
-  obj_t o;
-  byte c, t;
-} dot_t;
+  int x[MAXDOT], y[MAXDOT];
+  int xv[MAXDOT], yv[MAXDOT];
+  int vx[MAXDOT], vy[MAXDOT];
+  int px[MAXDOT], py[MAXDOT]; // see W_store
+  byte c[MAXDOT], t[MAXDOT];
+} dot_pool_t;
 
-extern dot_t dot[MAXDOT];
+/* DOT_move of a dot that stayed where it was, the same again while
+   the map and the speed it came with stay the same */
+typedef struct {
+  dword gen; // of z_envgen, 0 is empty
+  signed char xv, yv, vx, vy; // speed it came with
+  signed char nxv, nyv, nvx, nvy; // and left with
+  byte st;
+} dot_stay_t;
 
 void DOT_init (void);
 void DOT_alloc (void);
-void DOT_act (void);
+void DOT_move (int chunk); // may run in parallel, reads map only
+void DOT_settle (void); // after all DOT_move, in order
 void DOT_add (int x, int y, char xv, char yv, byte c, byte t);
 void DOT_blood (int x, int y, int xv, int yv, int n);
 void DOT_spark (int x, int y, int xv, int yv, int n);
@@ -0,0 +1,203 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame.h"
+#include <stdlib.h> // qsort
+#include <string.h>
+#include <time.h>
+#include <errno.h> // EINTR
+#include <assert.h>
+#include "game.h" // G_act
+#include "render.h" // R_draw
+#include "view.h" // W_ALPHA
+#include "error.h" // logo
+
+#define TICK_NS (DELAY * 1000000ULL)
+#define MAX_CATCHUP 5 // ticks per frame, game slows down when machine can't keep up
+#define FR_HZ 60 // display rate when driver does not know it
+
+static char pace[16];
+static dword fps;
+
+static int mode;
+static unsigned long long frame_ns; // FR_DISPLAY: time between frames
+static unsigned long long ticks; // time of last step, ns
+static unsigned long long lag; // not simulated yet, ns
+static unsigned long long next_frame; // FR_DISPLAY deadline
+
+static unsigned long long start; // FR_start
+static unsigned long long slept; // total, ns
+static unsigned long long last_draw;
+static dword frames;
+static dword ring[FR_RING]; // us between frames
+static int pos, num;
+
+const cfg_t *FR_args (void) {
+  static const cfg_t args[] = {
+    { "pace", pace, Y_STRING, sizeof(pace) },
+    { "fps", &fps, Y_DWORD },
+    { NULL, NULL, 0 } // end
+  };
+  return args;
+}
+
+static unsigned long long nanotime (void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  // clock() stops while we sleep, driver timer does not
+  return Y_get_ticks() * 1000000ULL;
+#endif
+}
+
+/* browser drives the loop itself, systems without POSIX clocks use driver delay */
+static void sleep_until (unsigned long long t) {
+#ifndef __EMSCRIPTEN__
+#  ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+#  endif
+  unsigned long long now = nanotime();
+  if (t <= now) {
+    return;
+  }
+#  if !defined(CLOCK_MONOTONIC)
+  Y_delay((t - now + 999999) / 1000000);
+#  elif defined(TIMER_ABSTIME) && !defined(__APPLE__)
+  ts.tv_sec = t / 1000000000ULL;
+  ts.tv_nsec = t % 1000000000ULL;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    // interrupted by signal, deadline is absolute
+  }
+#  else
+  ts.tv_sec = (t - now) / 1000000000ULL;
+  ts.tv_nsec = (t - now) % 1000000000ULL;
+  nanosleep(&ts, NULL);
+#  endif
+  slept += nanotime() - now;
+#endif
+}
+
+void FR_start (int hz) {
+  unsigned long long now = nanotime();
+  if (strcmp(pace, "ticks") == 0) {
+    mode = FR_TICKS;
+  } else if (strcmp(pace, "uncapped") == 0) {
+    mode = FR_UNCAPPED;
+  } else {
+    if (pace[0] != 0 && strcmp(pace, "display") != 0) {
+      logo("FR_start: unknown pace %s, using display\n", pace);
+    }
+    mode = FR_DISPLAY;
+  }
+  hz = fps > 0 ? fps : hz > 0 ? hz : FR_HZ;
+  frame_ns = 1000000000ULL / hz;
+  ticks = now;
+  lag = 0;
+  next_frame = now;
+  start = now;
+  slept = 0;
+  last_draw = now;
+  frames = 0;
+  pos = num = 0;
+}
+
+static void draw (unsigned long long now) {
+  R_draw(lag * W_ALPHA / TICK_NS);
+  if (frames > 0) {
+    ring[pos] = (now - last_draw) / 1000;
+    pos = (pos + 1) % FR_RING;
+    num = min(num + 1, FR_RING);
+  }
+  last_draw = now;
+  frames += 1;
+}
+
+void FR_step (void) {
+  int n;
+  unsigned long long t = nanotime();
+  lag += t - ticks;
+  ticks = t;
+  for (n = 0; lag >= TICK_NS && n < MAX_CATCHUP; n++) {
+    G_act();
+    lag -= TICK_NS;
+  }
+  if (lag >= TICK_NS) {
+    lag %= TICK_NS; // drop lost time
+  }
+  switch (mode) {
+    case FR_TICKS:
+      if (n > 0 || frames == 0) {
+        draw(t);
+      }
+      sleep_until(ticks + TICK_NS - lag);
+      break;
+    case FR_DISPLAY:
+      if (t >= next_frame) {
+        draw(t);
+        next_frame += frame_ns;
+        if (next_frame <= t) {
+          next_frame = t + frame_ns; // fell behind, don't try to catch up
+        }
+      }
+      sleep_until(min(next_frame, ticks + TICK_NS - lag));
+      break;
+    default:
+      draw(t);
+      break;
+  }
+}
+
+static int cmp_dword (const void *a, const void *b) {
+  dword x = *(const dword *)a;
+  dword y = *(const dword *)b;
+  return x < y ? -1 : x > y;
+}
+
+void FR_stat (fr_stat_t *st) {
+  int i;
+  unsigned long long sum, total;
+  dword buf[FR_RING];
+  assert(st != NULL);
+  st->frames = frames;
+  if (num > 0) {
+    sum = 0;
+    for (i = 0; i < num; i++) {
+      buf[i] = ring[(pos - num + i + FR_RING) % FR_RING];
+      sum += buf[i];
+    }
+    qsort(buf, num, sizeof(buf[0]), cmp_dword);
+    st->avg = sum / num;
+    st->p99 = buf[num * 99 / 100];
+    st->max = buf[num - 1];
+  } else {
+    st->avg = st->p99 = st->max = 0;
+  }
+  total = nanotime() - start;
+  st->busy = total > 0 ? 100 - slept * 100 / total : 100;
+}
+
+dword FR_last (void) {
+  return num > 0 ? ring[(pos - 1 + FR_RING) % FR_RING] : 0;
+}
+
+void FR_done (void) {
+  fr_stat_t st;
+  static const char *names[] = { "ticks", "display", "uncapped" };
+  FR_stat(&st);
+  logo("FR_done: pace %s, %u frames, avg %.2f ms, p99 %.2f ms, max %.2f ms, busy %u%%\n",
+    names[mode], st.frames, st.avg / 1e3, st.p99 / 1e3, st.max / 1e3, st.busy);
+}
@@ -0,0 +1,48 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_H_INCLUDED
+#define FRAME_H_INCLUDED
+
+#include "glob.h"
+#include "system.h" // cfg_t
+
+/*
+ * Main loop pacing: runs due ticks, draws when the mode asks for it and
+ * sleeps until the next tick or frame deadline instead of spinning.
+ *   -pace display   draw interpolated frames at -fps or display rate (default)
+ *   -pace ticks     draw only after new ticks, for headless or farm instances
+ *   -pace uncapped  draw as often as possible, never sleep
+ */
+
+enum { FR_TICKS, FR_DISPLAY, FR_UNCAPPED };
+
+#define FR_RING 256 // frames kept for statistics
+
+typedef struct fr_stat_t {
+  dword frames; // drawn since FR_start
+  dword avg, p99, max; // us between frames
+  dword busy; // percent of time not sleeping
+} fr_stat_t;
+
+const cfg_t *FR_args (void);
+
+void FR_start (int hz); // hz: display refresh rate, 0 if unknown
+void FR_step (void); // one main loop iteration
+void FR_stat (fr_stat_t *st);
+dword FR_last (void); // us between the last two frames
+void FR_done (void); // log statistics
+
+#endif /* FRAME_H_INCLUDED */
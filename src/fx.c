@@ -22,14 +22,16 @@
 #include "view.h"
 #include "fx.h"
 #include "misc.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
 
 enum{NONE,TFOG,IFOG,BUBL};
 
-fx_t fx[MAXFX];
+#define bubsn (world->fx_bubsn)
+#define last (world->fx_last)
 
 static void *bsnd[2];
-static char bubsn;
-static int last;
 
 //unsigned char fx_scr1[64000],fx_scr2[64000];
 
@@ -102,6 +104,7 @@ void FX_init (void) {
   int i;
 
   for(i=0;i<MAXFX;++i) fx[i].t=0;
+  LV_clear(fx_live,MAXFX);
   bubsn=0;
   last=0;
 }
@@ -111,28 +114,31 @@ void FX_act (void) {
   byte b;
 
   bubsn=0;
-  for(i=0;i<MAXFX;++i) switch(fx[i].t) {
-    case TFOG:
-      if(++fx[i].s>=20) fx[i].t=0;
-      break;
-    case IFOG:
-      if(++fx[i].s>=10) fx[i].t=0;
-      break;
-    case BUBL:
-      fx[i].yv-=5;
-      fx[i].xv=Z_dec(fx[i].xv,20);
-      fx[i].x+=fx[i].xv;
-      fx[i].y+=fx[i].yv;
-      if((b=fld[fx[i].y>>11][fx[i].x>>11]) < 5 || b>7) fx[i].t=0;
-      break;
+  LV_EACH(i,fx_live,MAXFX) {
+    switch(fx[i].t) {
+      case TFOG:
+        if(++fx[i].s>=20) fx[i].t=0;
+        break;
+      case IFOG:
+        if(++fx[i].s>=10) fx[i].t=0;
+        break;
+      case BUBL:
+        fx[i].yv-=5;
+        fx[i].xv=Z_dec(fx[i].xv,20);
+        fx[i].x+=fx[i].xv;
+        fx[i].y+=fx[i].yv;
+        if((b=fld[fx[i].y>>11][fx[i].x>>11]) < 5 || b>7) fx[i].t=0;
+        break;
+    }
+    LV_put(fx_live,i,fx[i].t);
   }
 }
 
 static int findfree (void) {
   int i;
 
-  for(i=0;i<MAXFX;++i) if(!fx[i].t) return i;
-  for(i=0;i<MAXFX;++i) if(fx[i].t==IFOG) return i;
+  if((i=LV_free(fx_live,MAXFX))<MAXFX) return i;
+  LV_EACH(i,fx_live,MAXFX) if(fx[i].t==IFOG) return i;
   if(++last>=MAXFX) last=0;
   return last;
 }
@@ -142,6 +148,7 @@ void FX_tfog (int x, int y) {
 
   i=findfree();
 	fx[i].t=TFOG;fx[i].s=0;
+	LV_put(fx_live,i,TFOG);
 	fx[i].x=x;fx[i].y=y;
 }
 
@@ -150,17 +157,19 @@ void FX_ifog (int x, int y) {
 
   i=findfree();
     fx[i].t=IFOG;fx[i].s=0;
+    LV_put(fx_live,i,IFOG);
     fx[i].x=x;fx[i].y=y;
 }
 
 void FX_bubble (int x, int y, int xv, int yv, int n) {
   int i;
 
-  if(!bubsn) {Z_sound(bsnd[rand()&1],128);bubsn=1;}
+  if(!bubsn) {Z_sound(bsnd[RND_rand(RND_FX)&1],128);bubsn=1;}
   for(;n>0;--n) {
 	i=findfree();
-	fx[i].t=BUBL;fx[i].s=rand()&3;
-	fx[i].x=(x<<8)+myrand(513)-256;fx[i].y=(y<<8)+myrand(513)-256;
-	fx[i].xv=xv;fx[i].yv=yv-myrand(256)-768;
+	fx[i].t=BUBL;fx[i].s=RND_rand(RND_FX)&3;
+	LV_put(fx_live,i,BUBL);
+	fx[i].x=(x<<8)+RND_mod(RND_FX,513)-256;fx[i].y=(y<<8)+RND_mod(RND_FX,513)-256;
+	fx[i].xv=xv;fx[i].yv=yv-RND_mod(RND_FX,256)-768;
   }
 }
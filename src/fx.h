@@ -18,15 +18,15 @@
 #ifndef FX_H_INLUDED
 #define FX_H_INLUDED
 
-#define MAXFX 300
+#include "glob.h" // POOL_SCALE
+
+#define MAXFX (300 * POOL_SCALE)
 
 typedef struct {
   int x, y, xv, yv;
   char t, s;
 } fx_t;
 
-extern fx_t fx[MAXFX];
-
 void FX_alloc (void);
 void FX_init (void);
 void FX_act (void);
@@ -41,6 +41,13 @@
 #include "a8.h"
 #include "error.h"
 #include "input.h"
+#include "prof.h"
+#include "rnd.h"
+#include "demo.h"
+#include "snap.h"
+#include "world.h"
+#include "job.h"
+#include "metrics.h"
 
 #include "save.h"
 
@@ -49,32 +56,16 @@
 
 #define GETIME 1092
 
+#define lt_force (world->lt_force)
+#define g_transt (world->g_transt)
+#define pcnt (world->pcnt)
+
 byte transdraw;
-byte _2pl;
-byte g_dm;
-byte g_st = GS_TITLE;
-byte g_exit;
-byte g_map = 1;
-char g_music[8] = "MENU";
-dword g_time;
-int dm_pnum;
-int dm_pl1p;
-int dm_pl2p;
-pos_t dm_pos[100];
 byte cheat;
 
 static void *telepsnd;
-
-int lt_time;
-int lt_type;
-int lt_side;
-int lt_ypos;
-static int lt_force;
 static void *ltnsnd[2];
 
-int g_trans;
-static int g_transt;
-
 static void set_trans(int st) {
   switch(g_st) {
     case GS_ENDANIM: case GS_END2ANIM: case GS_DARKEN:
@@ -92,23 +83,33 @@ static void set_trans(int st) {
 void load_game (int n) {
   MUS_free();
   W_init();
+  DEM_stop();
+  SN_reset();
   F_loadgame(n);
+  RND_start(G_seed() | g_time << 10);
   set_trans(GS_GAME);
   pl1.drawst=0xFF;
   if(_2pl) pl2.drawst=0xFF;
   BM_remapfld();
-  BM_clear(BM_PLR1|BM_PLR2|BM_MONSTER);
-  BM_mark(&pl1.o,BM_PLR1);
-  if(_2pl) BM_mark(&pl2.o,BM_PLR2);
-  MN_mark();
+  Z_remaptiles();
+  BM_reset();
+  BM_sync();
+  BM_regrid();
+  W_store();
   //MUS_start(music_time);
   MUS_start(0);
 }
 
+dword G_seed (void) {
+  return g_map | g_dm << 8 | _2pl << 9;
+}
+
 void G_start (void) {
   char s[8];
   MUS_free();
   sprintf(s,"MAP%02u",(word)g_map);
+  RND_start(G_seed());
+  SN_reset();
   F_loadmap(s);
   set_trans(GS_GAME);
   pl1.drawst=0xFF;
@@ -117,14 +118,17 @@ void G_start (void) {
   itm_rtime=(g_dm)?1092:0;
   p_immortal=0;PL_JUMP=10;
   g_time=0;
+  pcnt=0;
   lt_time=1000;
   lt_force=1;
   if(!_2pl) pl1.lives=3;
   BM_remapfld();
-  BM_clear(BM_PLR1|BM_PLR2|BM_MONSTER);
-  BM_mark(&pl1.o,BM_PLR1);
-  if(_2pl) BM_mark(&pl2.o,BM_PLR2);
-  MN_mark();
+  Z_remaptiles();
+  BM_reset();
+  BM_sync();
+  BM_regrid();
+  W_store();
+  DEM_start();
   //MUS_start(music_time);
   MUS_start(0);
 }
@@ -135,11 +139,16 @@ void G_init (void) {
   int i,j;
   char s[9];
 
+  W_use(W_alloc());
+  if (world == NULL) {
+    ERR_failinit("G_init: not enough memory for world");
+  }
   logo("G_init: setup game resources ");
   logo_gas(5,GGAS_TOTAL);
   telepsnd=Z_getsnd("TELEPT");
   ltnsnd[0]=Z_getsnd("THUND1");
   ltnsnd[1]=Z_getsnd("THUND2");
+  RND_start(0);
   DOT_alloc();
   SMK_alloc();
   FX_alloc();
@@ -148,12 +157,14 @@ void G_init (void) {
   SW_alloc();
   PL_alloc();
   MN_alloc();
+  SN_alloc();
   Z_initst();
+  PF_init();
+  JOB_init();
+  MT_init();
   logo_gas(GGAS_TOTAL,GGAS_TOTAL);
   logo("\n");
   GM_init();
-  pl1.color=0x70;
-  pl2.color=0x60;
   g_trans=0;
 }
 
@@ -193,8 +204,14 @@ static int G_end_video (void) {
   return 0;
 }
 
+/* dots and smoke only touch their own slots here, pieces run on JOB pool */
+static void move_particles (int i) {
+  if(i<DOT_CHUNKS) DOT_move(i);
+  else SMK_move(i-DOT_CHUNKS);
+}
+
 void G_act (void) {
-  static byte pcnt=0;
+  W_store();
 /*
   if(g_trans) {
     if(g_transt==0) {
@@ -265,41 +282,68 @@ void G_act (void) {
 	  return;
   }
 
-
+  if(I_pressed(SN_KEY)) {
+    if(SN_rewind()) DEM_stop();
+    return;
+  }
+  DEM_tick();
+  Z_holdsnd();
   if(sky_type==2) {
     if(lt_time>LT_DELAY || lt_force) {
-      if(!(rand()&31) || lt_force) {
+      if(!(RND_rand(RND_GAME)&31) || lt_force) {
         lt_force=0;
         lt_time=-LT_HITTIME;
-        lt_type=rand()%2;
-        lt_side=rand()&1;
-        lt_ypos=rand()&31;
-        Z_sound(ltnsnd[rand()&1],128);
+        lt_type=RND_rand(RND_GAME)%2;
+        lt_side=RND_rand(RND_GAME)&1;
+        lt_ypos=RND_rand(RND_GAME)&31;
+        Z_sound(ltnsnd[RND_rand(RND_GAME)&1],128);
       }
     }else ++lt_time;
   }
+  MT_begin();
+  PF_begin(PF_TICK);
   ++g_time;
   pl1.hit=0;pl1.hito=-3;
   if(_2pl) {pl2.hit=0;pl2.hito=-3;}
+  PF_begin(PF_CODE);
   G_code();
+  PF_end(PF_CODE);
 
+  PF_begin(PF_ITEMS);
   IT_act();
+  PF_end(PF_ITEMS);
+  PF_begin(PF_SWITCH);
   SW_act();
+  PF_end(PF_SWITCH);
+  PF_begin(PF_PLAYER);
   if(_2pl) {
 	if(pcnt) {PL_act(&pl1);PL_act(&pl2);}
 	else {PL_act(&pl2);PL_act(&pl1);}
 	pcnt^=1;
   }else PL_act(&pl1);
+  PF_end(PF_PLAYER);
+  PF_begin(PF_MONSTER);
   MN_act();
-  if(fld_need_remap) BM_remapfld();
-  BM_clear(BM_PLR1|BM_PLR2|BM_MONSTER);
-  BM_mark(&pl1.o,BM_PLR1);
-  if(_2pl) BM_mark(&pl2.o,BM_PLR2);
-  MN_mark();
+  PF_end(PF_MONSTER);
+  PF_begin(PF_BMAP);
+  BM_sync();
+  PF_end(PF_BMAP);
+  PF_begin(PF_WEAPON);
   WP_act();
-  DOT_act();
-  SMK_act();
+  PF_end(PF_WEAPON);
+  PF_begin(PF_MOVE);
+  JOB_run(DOT_CHUNKS + SMK_CHUNKS, move_particles);
+  PF_end(PF_MOVE);
+  PF_begin(PF_DOTS);
+  DOT_settle();
+  PF_end(PF_DOTS);
+  PF_begin(PF_SMOKE);
+  SMK_settle();
+  PF_end(PF_SMOKE);
+  PF_begin(PF_FX);
   FX_act();
+  PF_end(PF_FX);
+  PF_begin(PF_DAMAGE);
   if(_2pl) {
 	PL_damage(&pl1);PL_damage(&pl2);
 	if(!(pl1.f&PLF_PNSND) && pl1.pain) PL_cry(&pl1);
@@ -311,6 +355,12 @@ void G_act (void) {
 	if(!(pl1.f&PLF_PNSND) && pl1.pain) PL_cry(&pl1);
 	if((pl1.pain-=5) < 0) {pl1.pain=0;pl1.f&=(0xFFFF-PLF_PNSND);}
   }
+  PF_end(PF_DAMAGE);
+  Z_flushsnd();
+  SN_capture();
+  PF_end(PF_TICK);
+  MT_tick();
+  if(g_exit) DEM_stop();
   if(g_exit==1) {
 
 	if(G_end_video()) {
@@ -359,7 +409,7 @@ void G_respawn_player (player_t *p) {
     FX_tfog(dm_pos[i].x,dm_pos[i].y);Z_sound(telepsnd,128);
     return;
   }
-  do{i=myrand(dm_pnum);}while(i==dm_pl1p || i==dm_pl2p);
+  do{i=RND_mod(RND_GAME,dm_pnum);}while(i==dm_pl1p || i==dm_pl2p);
   p->o.x=dm_pos[i].x;p->o.y=dm_pos[i].y;p->d=dm_pos[i].d;
   if(p==&pl1) dm_pl1p=i; else dm_pl2p=i;
   FX_tfog(dm_pos[i].x,dm_pos[i].y);Z_sound(telepsnd,128);
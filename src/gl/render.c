@@ -36,6 +36,9 @@
 #include "smoke.h"
 #include "view.h"
 #include "switch.h" // sw_secrets
+#include "prof.h"
+#include "world.h"
+#include "live.h"
 
 #include "common/cp866.h"
 #include "common/endianness.h"
@@ -110,6 +113,8 @@ static rgb playpal[256];
 static byte bright[256];
 static GLuint lastTexture;
 static cache *root;
+static int pages; // caches allocated
+static int alpha; // interpolation alpha
 
 /* Game */
 static image scrnh[3]; // TITLEPIC INTERPIC ENDPIC
@@ -314,6 +319,7 @@ static cache *R_cache_new (void) {
           .root.r = w - 1,
           .root.b = h - 1
         };
+        pages += 1;
       } else {
         glDeleteTextures(1, &id);
       }
@@ -334,6 +340,7 @@ static void R_cache_free (cache *root, int freetexture) {
       glDeleteTextures(1, &c->id);
     }
     free(c);
+    pages -= 1;
     c = next;
   }
 }
@@ -1013,7 +1020,7 @@ static int GM_draw (void) {
 
 /* --- View --- */
 
-static void R_draw_fld (byte *fld, int minx, int miny, int maxx, int maxy, int fg) {
+static void R_draw_fld (byte *f, int minx, int miny, int maxx, int maxy, int fg) {
   int i, j;
   assert(minx >= 0 && minx <= FLDW);
   assert(miny >= 0 && miny <= FLDH);
@@ -1021,7 +1028,7 @@ static void R_draw_fld (byte *fld, int minx, int miny, int maxx, int maxy, int f
   assert(maxy >= 0 && maxy <= FLDH);
   for (j = miny; j < maxy; j++) {
     for (i = minx; i < maxx; i++) {
-      byte id = fld[j * FLDW + i];
+      byte id = f[j * FLDW + i];
       if (id != 0) {
         if (walp[id].res < 0) {
           if (fg) {
@@ -1058,22 +1065,22 @@ static void R_draw_dots (void) {
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   glDisable(GL_TEXTURE_2D);
   glBegin(GL_QUADS);
-  for (i = 0; i < MAXDOT; i++) {
-    if (dot[i].t != 0) {
-      int x = dot[i].o.x;
-      int y = dot[i].o.y;
-      R_gl_set_color(dot[i].c); glVertex2i(x + 1, y);
-      R_gl_set_color(dot[i].c); glVertex2i(x, y);
-      R_gl_set_color(dot[i].c); glVertex2i(x, y + 1);
-      R_gl_set_color(dot[i].c); glVertex2i(x + 1, y + 1);
+  LV_EACH(i, dot_live, MAXDOT) {
+    if (dot.t[i] != 0) {
+      int x, y;
+      W_lerp(dot.x[i], dot.y[i], dot.px[i], dot.py[i], alpha, &x, &y);
+      R_gl_set_color(dot.c[i]); glVertex2i(x + 1, y);
+      R_gl_set_color(dot.c[i]); glVertex2i(x, y);
+      R_gl_set_color(dot.c[i]); glVertex2i(x, y + 1);
+      R_gl_set_color(dot.c[i]); glVertex2i(x + 1, y + 1);
     }
   }
   glEnd();
 }
 
 static void R_draw_items (void) {
-  int i, s;
-  for (i = 0; i < MAXITEM; ++i) {
+  int i, s, x, y;
+  LV_EACH(i, it_live, MAXITEM) {
     s = -1;
     if (it[i].t && it[i].s >= 0) {
       switch (it[i].t & 0x7FFF) {
@@ -1117,7 +1124,8 @@ static void R_draw_items (void) {
       }
     }
     if (s >= 0) {
-      R_gl_draw_image(&item_spr[s], it[i].o.x, it[i].o.y, item_sprd[s]);
+      W_lerpobj(&it[i].o, alpha, &x, &y);
+      R_gl_draw_image(&item_spr[s], x, y, item_sprd[s]);
     }
   }
 }
@@ -1149,6 +1157,7 @@ static void R_draw_player (player_t *p) {
   int w = 0;
   int wx = 0;
   int wy = 0;
+  int x, y;
   switch (p->st) {
     case STAND:
       if (p->f & PLF_FIRE) {
@@ -1196,26 +1205,27 @@ static void R_draw_player (player_t *p) {
   if (p->wpn == 0) {
     w = 0;
   }
+  W_lerpobj(&p->o, alpha, &x, &y);
   if (w) {
-    R_gl_draw_image(&plr_wpn[(int)p->wpn][w -'A'], p->o.x + wx, p->o.y + wy, p->d);
+    R_gl_draw_image(&plr_wpn[(int)p->wpn][w -'A'], x + wx, y + wy, p->d);
   }
   if (s) {
-    R_gl_draw_image(&plr_spr[(s - 'A') * 2 + p->d], p->o.x, p->o.y, plr_sprd[(s - 'A') * 2 + p->d]);
+    R_gl_draw_image(&plr_spr[(s - 'A') * 2 + p->d], x, y, plr_sprd[(s - 'A') * 2 + p->d]);
     R_gl_set_color(p->color + PLAYER_COLOR_OFFSET);
-    R_gl_draw_image_color(&plr_msk[(s - 'A') * 2 + p->d], p->o.x, p->o.y, plr_sprd[(s - 'A') * 2 + p->d]);
+    R_gl_draw_image_color(&plr_msk[(s - 'A') * 2 + p->d], x, y, plr_sprd[(s - 'A') * 2 + p->d]);
   }
 }
 
 static void R_draw_monsters (void) {
   enum {SLEEP, GO, RUN, CLIMB, DIE, DEAD, ATTACK, SHOOT, PAIN, WAIT, REVIVE, RUNOUT}; // copypasted from monster.c!
   int i;
-  for (i = 0; i < MAXMN; i++) {
+  LV_EACH(i, mn_live, MAXMN) {
     if (mn[i].t != MN_NONE) {
-      int x = mn[i].o.x;
-      int y = mn[i].o.y;
+      int x, y;
+      W_lerpobj(&mn[i].o, alpha, &x, &y);
       if (mn[i].t < MN__LAST) {
         if ((mn[i].t != MN_SOUL && mn[i].t != MN_PAIN) || mn[i].st != DEAD) {
-          int ap = mn[i].ap[mn[i].ac];
+          int ap = mnc[i].ap[mnc[i].ac];
           int d = (ap - 'A') * 2 + mn[i].d;
           int dir = mn_sprd[mn[i].t - 1][d];
           if (mn[i].t == MN_MAN && (ap == 'E' || ap == 'F')) {
@@ -1228,7 +1238,7 @@ static void R_draw_monsters (void) {
           }
         }
         if (mn[i].t == MN_VILE && mn[i].st == SHOOT) {
-          R_gl_draw_image(&mn_fspr[mn[i].ac / 3], mn[i].tx, mn[i].ty, 0);
+          R_gl_draw_image(&mn_fspr[mnc[i].ac / 3], mnc[i].tx, mnc[i].ty, 0);
         }
       } else if (mn[i].t == MN_PL_DEAD || mn[i].t == MN_PL_MESS) {
         int type = mn[i].t - MN_PL_DEAD;
@@ -1243,7 +1253,7 @@ static void R_draw_monsters (void) {
 static void R_draw_weapons (void) {
   enum {NONE, ROCKET, PLASMA, APLASMA, BALL1, BALL2, BALL7, BFGBALL, BFGHIT, MANF, REVF, FIRE}; // copypasted from weapons.c!
   int i, s, d, x, y;
-  for (i = 0; i < MAXWPN; ++i) {
+  LV_EACH(i, wp_live, MAXWPN) {
     s = -1;
     d = 0;
     switch (wp[i].t) {
@@ -1319,14 +1329,15 @@ static void R_draw_weapons (void) {
         break;
     }
     if (s >= 0) {
-      R_gl_draw_image(&wp_spr[s * 2 + d], wp[i].o.x, wp[i].o.y, wp_sprd[s * 2 + d]);
+      W_lerpobj(&wp[i].o, alpha, &x, &y);
+      R_gl_draw_image(&wp_spr[s * 2 + d], x, y, wp_sprd[s * 2 + d]);
     }
   }
 }
 
 static void R_draw_smoke (void) {
   int i, s;
-  for (i = 0; i < MAXSMOK; ++i) {
+  LV_EACH(i, sm_live, MAXSMOK) {
     if (sm[i].t) {
       switch (sm[i].s) {
         case 0:
@@ -1355,7 +1366,7 @@ static void R_draw_smoke (void) {
 static void R_draw_effects (void) {
   enum {NONE, TFOG, IFOG, BUBL}; // copypasted from fx.c
   int i, s;
-  for (i = 0; i < MAXFX; ++i) {
+  LV_EACH(i, fx_live, MAXFX) {
     switch (fx[i].t) {
       case TFOG:
         s = fx[i].s / 2;
@@ -1439,8 +1450,10 @@ static void R_draw_player_view (player_t *p, int x, int y, int w, int h) {
   p->looky = min(max(p->looky, -SCRH / 4), SCRH / 4); // TODO remove writeback
   int st = stone.w;
   int cw = w - st;
-  int cx = min(max(p->o.x, cw / 2), FLDW * CELW - cw / 2);
-  int cy = min(max(p->o.y - 12 + p->looky, h / 2), FLDH * CELH - h / 2);
+  int px, py;
+  W_lerpobj(&p->o, alpha, &px, &py);
+  int cx = min(max(px, cw / 2), FLDW * CELW - cw / 2);
+  int cy = min(max(py - 12 + p->looky, h / 2), FLDH * CELH - h / 2);
   int camx = max(cx - cw / 2, 0);
   int camy = max(cy - h / 2, 0);
   glPushMatrix();
@@ -1564,12 +1577,12 @@ static void pl_info (player_t *p, int x, int y) {
 
 static void R_draw_intermission (void) {
   int cx = SCRW / 2;
-  word hr, mn, sc, h;
+  word hr, mi, sc, h;
   Z_gotoxy(cx - 14*12/2, 20);
   Z_printbf("LEVEL COMPLETE");
-  Z_calc_time(g_time, &hr, &mn, &sc);
+  Z_calc_time(g_time, &hr, &mi, &sc);
   Z_gotoxy(cx - 12*12/2, 40);
-  Z_printbf("TIME %u:%02u:%02u", hr, mn, sc);
+  Z_printbf("TIME %u:%02u:%02u", hr, mi, sc);
   h = 40 + SCRH / 10;
   if (_2pl) {
     Z_gotoxy(cx - 10*12/2, h);
@@ -1587,8 +1600,10 @@ static void R_draw_intermission (void) {
 }
 
 static void W_act (void) {
+  static dword t;
   int i, a;
-  if (g_time % 3 == 0) {
+  if (g_time != t && g_time % 3 == 0) {
+    t = g_time; // R_draw called many times per tick
     for (i = 1; i < max_textures; i++) {
       a = walani[i];
       if (a != 0) {
@@ -1602,7 +1617,17 @@ static void W_act (void) {
   }
 }
 
-void R_draw (void) {
+/* --- profiler --- */
+
+#ifdef PROFILER
+static void PF_text (int x, int y, const char *s) {
+  Z_gotoxy(x, y);
+  Z_printsf("%s", s);
+}
+#endif
+
+void R_draw (int a) {
+  alpha = a;
   W_act();
   glClearColor(0, 0, 0, 1);
   glClear(GL_COLOR_BUFFER_BIT);
@@ -1634,6 +1659,9 @@ void R_draw (void) {
         R_draw_player_view(&pl1, 0, 0, SCRW, SCRH);
       }
       R_gl_setclip(0, 0, SCRW, SCRH);
+#ifdef PROFILER
+      PF_draw(PF_text);
+#endif
       break;
   }
   GM_draw();
@@ -1898,7 +1926,7 @@ static int video_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
   static int vmode;
   const videomode_t *v;
   enum { VIDEOMODE, FULLSCREEN, APPLY, __NUM__ };
-  static const simple_menu_t sm = {
+  static const simple_menu_t smenu = {
     GM_BIG, "Video", NULL,
     {
       { "Mode: ", NULL },
@@ -1948,7 +1976,7 @@ static int video_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
       case GM_SELECT: R_set_videomode(w, h, fullscreen); return 1;
     }
   }
-  return simple_menu_handler(msg, i, __NUM__, &sm, &cur);
+  return simple_menu_handler(msg, i, __NUM__, &smenu, &cur);
 }
 
 const menu_t *R_menu (void) {
@@ -2127,3 +2155,7 @@ int R_get_swp (int n) {
   assert(n >= 0 && n < 256);
   return walswp[n];
 }
+
+int R_atlas_pages (void) {
+  return pages;
+}
@@ -52,4 +52,23 @@ typedef unsigned int dword;
 
 #define DELAY 50
 
+/*
+ * Entity pools are this many times the original sizes, for stress maps.
+ * Caps stay fixed at compile time and full pools still drop or refuse new
+ * entities. world_t, each of the SN_MAX snapshots and the per-tick scans
+ * of the live bitsets all grow with the cap, not with what a map uses.
+ */
+#ifndef POOL_SCALE
+#  define POOL_SCALE 1
+#endif
+
+// state private to one thread, see world.h
+#if defined(_MSC_VER)
+#  define W_THREAD __declspec(thread)
+#elif defined(__GNUC__)
+#  define W_THREAD __thread
+#else
+#  define W_THREAD _Thread_local
+#endif
+
 #endif /* GLOB_H_INCLUDED */
@@ -15,10 +15,11 @@
 
 #include "input.h"
 #include "common/cp866.h"
+#include "glob.h" // W_THREAD
 
 #include <assert.h>
 
-static char keystate[KEY__LAST + 1];
+static W_THREAD char keystate[KEY__LAST + 1]; // every world thread feeds its own keys
 
 const char *I_key_to_string (int key) {
   switch (key) {
@@ -28,26 +28,23 @@
 #include "map.h"
 #include "files.h"
 #include "game.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
 
-item_t it[MAXITEM];
+#define tsndtm (world->it_tsndtm)
+#define rsndtm (world->it_rsndtm)
 
 static void *snd[4];
-static int tsndtm, rsndtm;
-
-int itm_rtime = 1092;
 
 void IT_alloc (void) {
-  int i, j, n;
+  int i;
   static char nm[][6] = {
     "ITEMUP", "WPNUP", "GETPOW", "ITMBK"
   };
   for (i = 0; i < 4; ++i) {
     snd[i] = Z_getsnd(nm[i]);
   }
-  for (i = 0; i < MAXITEM; ++i) {
-    it[i].o.r = 10;
-    it[i].o.h = 8;
-  }
 }
 
 void IT_init (void) {
@@ -58,7 +55,10 @@ void IT_init (void) {
     it[i].o.yv = 0;
     it[i].o.vx = 0;
     it[i].o.vy = 0;
+    it[i].o.r = 10;
+    it[i].o.h = 8;
   }
+  LV_clear(it_live, MAXITEM);
   tsndtm = 0;
   rsndtm = 0;
 }
@@ -73,12 +73,16 @@ static void takesnd (int t) {
   tsndtm=Z_sound(snd[0], 255);
 }
 
+static void release (int i) {
+  it[i].t=0;LV_put(it_live,i,0);
+}
+
 void IT_act (void) {
   int i,j;
 
   if(tsndtm) --tsndtm;
   if(rsndtm) --rsndtm;
-  for(i=0;i<MAXITEM;++i) if(it[i].t)
+  LV_EACH(i,it_live,MAXITEM)
     if(it[i].s<0) {
       if(++it[i].s==-8) {
 		FX_ifog(it[i].o.x,it[i].o.y);
@@ -95,21 +99,21 @@ void IT_act (void) {
 		  if(++it[i].s>=6) it[i].s=0; break;
       }
 	  if(it[i].t&0x8000) {
-		if((j=Z_moveobj(&it[i].o))&Z_FALLOUT) {it[i].t=0;continue;}
+		if((j=Z_moveobj(&it[i].o,&world->it_env[i]))&Z_FALLOUT) {release(i);continue;}
 		else if(j&Z_HITWATER) Z_splash(&it[i].o,it[i].o.r+it[i].o.h);
 	  }
       if(Z_overlap(&it[i].o,&pl1.o))
 		if(PL_give(&pl1,it[i].t&0x7FFF)) {
 		  takesnd(it[i].t);
 		  if(_2pl) if((it[i].t&0x7FFF)>=I_KEYR && (it[i].t&0x7FFF)<=I_KEYB) continue;
-		  if(!(it[i].s=-itm_rtime) || (it[i].t&0x8000)) it[i].t=0;
+		  if(!(it[i].s=-itm_rtime) || (it[i].t&0x8000)) release(i);
 		  continue;
 		}
 	  if(_2pl) if(Z_overlap(&it[i].o,&pl2.o))
 		if(PL_give(&pl2,it[i].t&0x7FFF)) {
 		  takesnd(it[i].t);
 		  if((it[i].t&0x7FFF)>=I_KEYR && (it[i].t&0x7FFF)<=I_KEYB) continue;
-		  if(!(it[i].s=-itm_rtime) || (it[i].t&0x8000)) it[i].t=0;
+		  if(!(it[i].s=-itm_rtime) || (it[i].t&0x8000)) release(i);
 		  continue;
 		}
 	}
@@ -118,13 +122,12 @@ void IT_act (void) {
 void IT_spawn (int x,int y,int t) {
   int i;
 
-  for(i=0;i<MAXITEM;++i) if(!it[i].t) {
-	it[i].t=t|0x8000;it[i].s=0;
-    it[i].o.x=x;it[i].o.y=y;
-    it[i].o.xv=it[i].o.yv=it[i].o.vx=it[i].o.vy=0;
-    it[i].o.r=10;it[i].o.h=8;
-    return;
-  }
+  if((i=LV_free(it_live,MAXITEM))>=MAXITEM) return;
+  it[i].t=t|0x8000;it[i].s=0;
+  LV_put(it_live,i,it[i].t);
+  it[i].o.x=x;it[i].o.y=y;
+  it[i].o.xv=it[i].o.yv=it[i].o.vx=it[i].o.vy=0;
+  it[i].o.r=10;it[i].o.h=8;
 }
 
 void IT_drop_ammo (int t, int n, int x, int y) {
@@ -133,6 +136,6 @@ void IT_drop_ammo (int t, int n, int x, int y) {
 
 again:;
   for(a=an[t-I_CLIP];n>=a;n-=a)
-	IT_spawn(x+myrand(3*2+1)-3,y-myrand(7),t);
+	IT_spawn(x+RND_mod(RND_ITEMS,3*2+1)-3,y-RND_mod(RND_ITEMS,7),t);
   if(t>=I_AMMO) {t-=4;goto again;}
 }
@@ -20,7 +20,7 @@
 
 #include "view.h" // obj_t
 
-#define MAXITEM 300
+#define MAXITEM (300 * POOL_SCALE)
 
 enum {
   I_NONE, I_CLIP, I_SHEL, I_ROCKET, I_CELL, I_AMMO, I_SBOX, I_RBOX, I_CELP,
@@ -31,13 +31,10 @@ enum {
 
 typedef struct {
   obj_t o;
-  int t;
-  int s;
+  word t; // | 0x8000 if it does not respawn
+  short s;
 } item_t;
 
-extern item_t it[MAXITEM];
-extern int itm_rtime;
-
 void IT_alloc (void);
 void IT_init (void);
 void IT_act (void);
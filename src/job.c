@@ -0,0 +1,151 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "job.h"
+#include <stdlib.h> // atexit
+#include <assert.h>
+#include "glob.h"
+#include "world.h" // world W_use
+#include "error.h" // logo
+
+static byte jobs; // -jobs: worker threads besides the caller
+
+const cfg_t *JOB_args (void) {
+  static const cfg_t args[] = {
+    { "jobs", &jobs, Y_BYTE },
+    { NULL, NULL, 0 } // end
+  };
+  return args;
+}
+
+#ifdef JOBS
+
+#include <pthread.h>
+
+static pthread_t th[JOB_MAX];
+static int nth;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t idle = PTHREAD_COND_INITIALIZER;
+/* one job at a time, other worlds run theirs alone meanwhile */
+static pthread_mutex_t busy = PTHREAD_MUTEX_INITIALIZER;
+
+static void (*job_f)(int i);
+static int job_n; // pieces
+static int job_next; // first piece nobody took yet
+static int job_left; // pieces not finished
+static world_t *job_w;
+static unsigned job_gen; // bumped for every job
+static int quit;
+
+/* take pieces until none left, lock is held on entry and exit */
+static void work (void) {
+  int i;
+  while (job_next < job_n) {
+    i = job_next++;
+    pthread_mutex_unlock(&lock);
+    job_f(i);
+    pthread_mutex_lock(&lock);
+    if (--job_left == 0) {
+      pthread_cond_signal(&idle);
+    }
+  }
+}
+
+static void *worker (void *arg) {
+  unsigned gen = 0;
+  pthread_mutex_lock(&lock);
+  while (!quit) {
+    if (gen == job_gen) {
+      pthread_cond_wait(&wake, &lock);
+    } else {
+      gen = job_gen;
+      W_use(job_w);
+      work();
+    }
+  }
+  pthread_mutex_unlock(&lock);
+  return NULL;
+}
+
+static void JOB_done (void) {
+  int i;
+  pthread_mutex_lock(&lock);
+  quit = 1;
+  pthread_cond_broadcast(&wake);
+  pthread_mutex_unlock(&lock);
+  for (i = 0; i < nth; i++) {
+    pthread_join(th[i], NULL);
+  }
+  nth = 0;
+}
+
+void JOB_init (void) {
+  int n = min(jobs, JOB_MAX);
+  if (nth > 0 || n == 0) {
+    return;
+  }
+  while (nth < n && pthread_create(&th[nth], NULL, worker, NULL) == 0) {
+    nth += 1;
+  }
+  logo("JOB_init: %i worker threads\n", nth);
+  if (nth > 0) {
+    atexit(JOB_done);
+  }
+}
+
+void JOB_run (int n, void (*f)(int i)) {
+  int i;
+  assert(f != NULL);
+  if (nth == 0 || n <= 1 || pthread_mutex_trylock(&busy) != 0) {
+    for (i = 0; i < n; i++) {
+      f(i);
+    }
+    return;
+  }
+  pthread_mutex_lock(&lock);
+  job_f = f;
+  job_n = n;
+  job_next = 0;
+  job_left = n;
+  job_w = world;
+  job_gen += 1;
+  pthread_cond_broadcast(&wake);
+  work();
+  while (job_left > 0) {
+    pthread_cond_wait(&idle, &lock);
+  }
+  pthread_mutex_unlock(&lock);
+  pthread_mutex_unlock(&busy);
+}
+
+#else /* JOBS */
+
+void JOB_init (void) {
+  if (jobs > 0) {
+    logo("JOB_init: built without threads, -jobs ignored\n");
+  }
+}
+
+void JOB_run (int n, void (*f)(int i)) {
+  int i;
+  assert(f != NULL);
+  for (i = 0; i < n; i++) {
+    f(i);
+  }
+}
+
+#endif /* JOBS */
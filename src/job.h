@@ -0,0 +1,35 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOB_H_INCLUDED
+#define JOB_H_INCLUDED
+
+#include "system.h" // cfg_t
+
+/*
+ * Small worker pool for work split into independent pieces within one
+ * tick. Workers run on the world of the thread that called JOB_run. Off
+ * unless -jobs N is given or the build has no threads, pieces then run in
+ * order on the calling thread. Results must not depend on the order.
+ */
+
+#define JOB_MAX 8 // worker threads at most
+
+const cfg_t *JOB_args (void);
+
+void JOB_init (void); // G_init: start workers
+void JOB_run (int n, void (*f)(int i)); // f(0) .. f(n-1), returns when all done
+
+#endif /* JOB_H_INCLUDED */
@@ -23,7 +23,7 @@
 #include "system.h"
 #include "input.h"
 
-#include "player.h" // pl1 pl2
+#include "player.h" // pl1_keys pl2_keys
 #include "menu.h" // G_keyf
 #include "error.h" // logo
 #include "monster.h" // nomon
@@ -36,6 +36,10 @@
 #include "sound.h" // S_init S_done
 #include "music.h" // S_initmusic S_updatemusic S_donemusic
 #include "render.h" // R_init R_draw R_done
+#include "view.h" // W_ALPHA
+#include "demo.h" // DEM_args DEM_timedemo DEM_stop
+#include "job.h" // JOB_args
+#include "metrics.h" // MT_args
 
 static int quit = 0;
 static videomode_size_t wlist[3] = {
@@ -72,30 +76,30 @@ static const cfg_t cfg[] = {
 //  {"music_random", &music_random, Y_SW_ON},
 //  {"music_time", &music_time, Y_DWORD},
 //  {"music_fade", &music_fade, Y_DWORD},
-  {"pl1_left", &pl1.kl, Y_KEY},
-  {"pl1_right",&pl1.kr, Y_KEY},
-  {"pl1_up", &pl1.ku, Y_KEY},
-  {"pl1_down", &pl1.kd, Y_KEY},
-  {"pl1_jump", &pl1.kj, Y_KEY},
-  {"pl1_fire", &pl1.kf, Y_KEY},
-  {"pl1_next", &pl1.kwr, Y_KEY},
-  {"pl1_prev", &pl1.kwl, Y_KEY},
-  {"pl1_use", &pl1.kp, Y_KEY},
-  {"pl2_left", &pl2.kl, Y_KEY},
-  {"pl2_right", &pl2.kr, Y_KEY},
-  {"pl2_up", &pl2.ku, Y_KEY},
-  {"pl2_down", &pl2.kd, Y_KEY},
-  {"pl2_jump", &pl2.kj, Y_KEY},
-  {"pl2_fire", &pl2.kf, Y_KEY},
-  {"pl2_next", &pl2.kwr, Y_KEY},
-  {"pl2_prev", &pl2.kwl, Y_KEY},
-  {"pl2_use", &pl2.kp, Y_KEY},
+  {"pl1_left", &pl1_keys.kl, Y_KEY},
+  {"pl1_right",&pl1_keys.kr, Y_KEY},
+  {"pl1_up", &pl1_keys.ku, Y_KEY},
+  {"pl1_down", &pl1_keys.kd, Y_KEY},
+  {"pl1_jump", &pl1_keys.kj, Y_KEY},
+  {"pl1_fire", &pl1_keys.kf, Y_KEY},
+  {"pl1_next", &pl1_keys.kwr, Y_KEY},
+  {"pl1_prev", &pl1_keys.kwl, Y_KEY},
+  {"pl1_use", &pl1_keys.kp, Y_KEY},
+  {"pl2_left", &pl2_keys.kl, Y_KEY},
+  {"pl2_right", &pl2_keys.kr, Y_KEY},
+  {"pl2_up", &pl2_keys.ku, Y_KEY},
+  {"pl2_down", &pl2_keys.kd, Y_KEY},
+  {"pl2_jump", &pl2_keys.kj, Y_KEY},
+  {"pl2_fire", &pl2_keys.kf, Y_KEY},
+  {"pl2_next", &pl2_keys.kwr, Y_KEY},
+  {"pl2_prev", &pl2_keys.kwl, Y_KEY},
+  {"pl2_use", &pl2_keys.kp, Y_KEY},
   {NULL, NULL, 0} // end
 };
 
 static void CFG_args (int argc, char **argv) {
-  const cfg_t *list[] = { arg, R_args(), S_args(), MUS_args() };
-  ARG_parse(argc, argv, 4, list);
+  const cfg_t *list[] = { arg, R_args(), S_args(), MUS_args(), DEM_args(), JOB_args(), MT_args() };
+  ARG_parse(argc, argv, 7, list);
 }
 
 static void CFG_load (void) {
@@ -276,6 +280,14 @@ void Y_disable_text_input (void) {
   SetInputMode(KOS32_INPUT_MODE_SCANCODE);
 }
 
+dword Y_get_ticks (void) {
+  return GetTimeCount() * 10;
+}
+
+void Y_delay (dword ms) {
+  Delay((ms + 9) / 10);
+}
+
 /* --- main --- */
 
 static int scancode_to_key (int scancode) {
@@ -535,7 +547,7 @@ static void game_loop (void) {
         G_act();
         n -= 1;
       }
-      R_draw();
+      R_draw(W_ALPHA);
     }
     Delay(1);
   }
@@ -547,25 +559,25 @@ int main (int argc, char **argv) {
   SetEventsMask(KOS32_EVENT_FLAG_REDRAW | KOS32_EVENT_FLAG_KEYBOARD | KOS32_EVENT_FLAG_BUTTON);
   Y_disable_text_input();
   // Player 1 defaults
-  pl1.ku = KEY_KP_8;
-  pl1.kd = KEY_KP_5;
-  pl1.kl = KEY_KP_4;
-  pl1.kr = KEY_KP_6;
-  pl1.kf = KEY_PAGEDOWN;
-  pl1.kj = KEY_DELETE;
-  pl1.kwl = KEY_HOME;
-  pl1.kwr = KEY_END;
-  pl1.kp = KEY_KP_8;
+  pl1_keys.ku = KEY_KP_8;
+  pl1_keys.kd = KEY_KP_5;
+  pl1_keys.kl = KEY_KP_4;
+  pl1_keys.kr = KEY_KP_6;
+  pl1_keys.kf = KEY_PAGEDOWN;
+  pl1_keys.kj = KEY_DELETE;
+  pl1_keys.kwl = KEY_HOME;
+  pl1_keys.kwr = KEY_END;
+  pl1_keys.kp = KEY_KP_8;
   // Player 2 defaults
-  pl2.ku = KEY_E;
-  pl2.kd = KEY_D;
-  pl2.kl = KEY_S;
-  pl2.kr = KEY_F;
-  pl2.kf = KEY_A;
-  pl2.kj = KEY_Q;
-  pl2.kwl = KEY_1;
-  pl2.kwr = KEY_2;
-  pl2.kp = KEY_E;
+  pl2_keys.ku = KEY_E;
+  pl2_keys.kd = KEY_D;
+  pl2_keys.kl = KEY_S;
+  pl2_keys.kr = KEY_F;
+  pl2_keys.kf = KEY_A;
+  pl2_keys.kj = KEY_Q;
+  pl2_keys.kwl = KEY_1;
+  pl2_keys.kwr = KEY_2;
+  pl2_keys.kp = KEY_E;
   srand(GetIdleCount());
   CFG_load();
   F_addwad("doom2d.wad");
@@ -574,9 +586,11 @@ int main (int argc, char **argv) {
   MUS_init();
   R_init();
   G_init();
+  quit = DEM_timedemo();
   logo("system: game loop\n");
   game_loop();
   logo("system: finalize engine\n");
+  DEM_stop();
   CFG_save();
   R_done();
   MUS_done();
@@ -0,0 +1,87 @@
+/* Copyright (C) 1996-1997 Aleksey Volynskov
+ * Copyright (C) 2011 Rambo
+ * Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glob.h"
+#include <string.h> // memset
+#include "live.h"
+
+/* lowest bit of a word that is not 0 */
+static int low (uint64_t m) {
+#ifdef __GNUC__
+  return __builtin_ctzll(m);
+#else
+  int i = 0;
+  while (!(m & 1)) {
+    m >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+void LV_clear (uint64_t *l, int n) {
+  memset(l, 0, LV_WORDS(n) * sizeof(l[0]));
+}
+
+void LV_put (uint64_t *l, int i, int t) {
+  uint64_t b = 1ULL << (i & 63);
+  if (t != 0) {
+    l[i >> 6] |= b;
+  } else {
+    l[i >> 6] &= ~b;
+  }
+}
+
+int LV_next (const uint64_t *l, int n, int i) {
+  int w;
+  uint64_t m;
+  if (i >= n) {
+    return n;
+  }
+  w = i >> 6;
+  m = l[w] & (~0ULL << (i & 63));
+  while (m == 0) {
+    if (++w >= LV_WORDS(n)) {
+      return n;
+    }
+    m = l[w];
+  }
+  i = w * 64 + low(m);
+  return i < n ? i : n;
+}
+
+int LV_free (const uint64_t *l, int n) {
+  int w, i;
+  for (w = 0; w < LV_WORDS(n); w++) {
+    if (~l[w] != 0) {
+      i = w * 64 + low(~l[w]);
+      return i < n ? i : n;
+    }
+  }
+  return n;
+}
+
+int LV_count (const uint64_t *l, int n) {
+  int w, k;
+  uint64_t m;
+  for (w = k = 0; w < LV_WORDS(n); w++) {
+    for (m = l[w]; m != 0; m &= m - 1) {
+      k++;
+    }
+  }
+  return k;
+}
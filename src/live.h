@@ -0,0 +1,41 @@
+/* Copyright (C) 1996-1997 Aleksey Volynskov
+ * Copyright (C) 2011 Rambo
+ * Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIVE_H_INCLUDED
+#define LIVE_H_INCLUDED
+
+#include "glob.h"
+#include <stdint.h> // uint64_t
+
+/*
+ * Slots of an entity pool in use, one bit per slot, set exactly while the
+ * slot's t is not 0. Walks go in ascending slot order like a full scan and
+ * see slots taken or freed on the way, new slots are the lowest free ones,
+ * so the game plays the same as with the scans over whole arrays.
+ */
+
+#define LV_WORDS(n) (((n) + 63) / 64)
+
+void LV_clear (uint64_t *l, int n); // all free
+void LV_put (uint64_t *l, int i, int t); // in use if t is not 0
+int LV_next (const uint64_t *l, int n, int i); // first in use from i on, n if none
+int LV_free (const uint64_t *l, int n); // lowest free, n if none
+int LV_count (const uint64_t *l, int n);
+
+#define LV_EACH(i, l, n) for ((i) = LV_next((l), (n), 0); (i) < (n); (i) = LV_next((l), (n), (i) + 1))
+
+#endif /* LIVE_H_INCLUDED */
@@ -23,6 +23,9 @@
 #include "monster.h"
 #include "switch.h"
 #include "view.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
 
 #include "music.h"
 #include "render.h"
@@ -60,7 +63,7 @@ typedef struct old_thing_t {
   unsigned short f;
 } old_thing_t;
 
-static map_block_t blk;
+static W_THREAD map_block_t blk;
 
 static int G_load (Stream *h) {
   switch (blk.t) {
@@ -141,9 +144,9 @@ static int IT_load (Stream *h) {
     }
 	  if (g_dm) {
 	    dm_pnum = j;
-	    dm_pl1p = myrand(dm_pnum);
+	    dm_pl1p = RND_mod(RND_GAME,dm_pnum);
 	    do {
-        dm_pl2p = myrand(dm_pnum);
+        dm_pl2p = RND_mod(RND_GAME,dm_pnum);
       } while (dm_pl2p == dm_pl1p);
 	  } else {
       dm_pl1p = 0;
@@ -165,6 +168,7 @@ static int IT_load (Stream *h) {
         MN_spawn(it[i].o.x, it[i].o.y, it[i].s & THF_DIR, it[i].t - TH_DEMON + MN_DEMON);
         it[i].t = 0;
       }
+      LV_put(it_live, i, it[i].t);
     }
 	  return 1;
   }
@@ -192,6 +196,7 @@ static int SW_load (Stream *h) {
         if (sw[i].t == SW_SECRET) {
           ++sw_secrets;
         }
+        LV_put(sw_live, i, sw[i].t);
       }
       return 1;
   }
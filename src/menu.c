@@ -33,6 +33,9 @@
 #include "system.h"
 
 #include "save.h"
+#include "prof.h"
+#include "demo.h"
+#include "world.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -56,24 +59,24 @@ static const cfg_t cfg[] = {
 //  {"music_random", &music_random, Y_SW_ON},
 //  {"music_time", &music_time, Y_DWORD},
 //  {"music_fade", &music_fade, Y_DWORD},
-  {"pl1_left", &pl1.kl, Y_KEY},
-  {"pl1_right",&pl1.kr, Y_KEY},
-  {"pl1_up", &pl1.ku, Y_KEY},
-  {"pl1_down", &pl1.kd, Y_KEY},
-  {"pl1_jump", &pl1.kj, Y_KEY},
-  {"pl1_fire", &pl1.kf, Y_KEY},
-  {"pl1_next", &pl1.kwr, Y_KEY},
-  {"pl1_prev", &pl1.kwl, Y_KEY},
-  {"pl1_use", &pl1.kp, Y_KEY},
-  {"pl2_left", &pl2.kl, Y_KEY},
-  {"pl2_right", &pl2.kr, Y_KEY},
-  {"pl2_up", &pl2.ku, Y_KEY},
-  {"pl2_down", &pl2.kd, Y_KEY},
-  {"pl2_jump", &pl2.kj, Y_KEY},
-  {"pl2_fire", &pl2.kf, Y_KEY},
-  {"pl2_next", &pl2.kwr, Y_KEY},
-  {"pl2_prev", &pl2.kwl, Y_KEY},
-  {"pl2_use", &pl2.kp, Y_KEY},
+  {"pl1_left", &pl1_keys.kl, Y_KEY},
+  {"pl1_right",&pl1_keys.kr, Y_KEY},
+  {"pl1_up", &pl1_keys.ku, Y_KEY},
+  {"pl1_down", &pl1_keys.kd, Y_KEY},
+  {"pl1_jump", &pl1_keys.kj, Y_KEY},
+  {"pl1_fire", &pl1_keys.kf, Y_KEY},
+  {"pl1_next", &pl1_keys.kwr, Y_KEY},
+  {"pl1_prev", &pl1_keys.kwl, Y_KEY},
+  {"pl1_use", &pl1_keys.kp, Y_KEY},
+  {"pl2_left", &pl2_keys.kl, Y_KEY},
+  {"pl2_right", &pl2_keys.kr, Y_KEY},
+  {"pl2_up", &pl2_keys.ku, Y_KEY},
+  {"pl2_down", &pl2_keys.kd, Y_KEY},
+  {"pl2_jump", &pl2_keys.kj, Y_KEY},
+  {"pl2_fire", &pl2_keys.kf, Y_KEY},
+  {"pl2_next", &pl2_keys.kwr, Y_KEY},
+  {"pl2_prev", &pl2_keys.kwl, Y_KEY},
+  {"pl2_use", &pl2_keys.kp, Y_KEY},
   {NULL, NULL, 0} // end
 };
 const cfg_t *list[] = { cfg };
@@ -195,6 +198,7 @@ static int start_game (int twoplayers, int dm, int level) {
   PL_reset();
   pl1.color = pcolortab[p1color];
   pl2.color = pcolortab[p2color];
+  DEM_stop();
   G_start();
   return GM_popall();
 }
@@ -202,7 +206,7 @@ static int start_game (int twoplayers, int dm, int level) {
 static int new_game_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
   static int cur;
   enum { ONEPLAYER, TWOPLAYERS, DEATHMATCH, NG__NUM__ };
-  static const simple_menu_t sm = {
+  static const simple_menu_t smenu = {
     GM_BIG, "New Game", "_NEWGAME",
     {
       { "One Player", NULL },
@@ -218,7 +222,7 @@ static int new_game_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
       // GM_say("_COOP");
     }
   }
-  return simple_menu_handler(msg, i, NG__NUM__, &sm, &cur);
+  return simple_menu_handler(msg, i, NG__NUM__, &smenu, &cur);
 }
 
 static int load_game_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
@@ -347,13 +351,13 @@ static int options_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
   enum { VIDEO, SOUND, MUSIC, CONTROLS_1, CONTROLS_2, OPT__NUM__ };
   static const controls_menu_t c1 = {
     { controls_menu_handler },
-    &pl1.ku
+    &pl1_keys.ku
   };
   static const controls_menu_t c2 = {
     { controls_menu_handler },
-    &pl2.ku
+    &pl2_keys.ku
   };
-  static const simple_menu_t sm = {
+  static const simple_menu_t smenu = {
     GM_BIG, "Options", NULL,
     {
       { "Video", NULL },
@@ -374,13 +378,13 @@ static int options_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
       return GM_push(mm);
     }
   }
-  return simple_menu_handler(msg, i, OPT__NUM__, &sm, &cur);
+  return simple_menu_handler(msg, i, OPT__NUM__, &smenu, &cur);
 }
 
 static int exit_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
   static int cur;
   enum { YES, NO, EXIT__NUM__ };
-  static const simple_menu_t sm = {
+  static const simple_menu_t smenu = {
     GM_SMALL, "You are sure?", NULL,
     {
       { "Yes", NULL },
@@ -406,7 +410,7 @@ static int exit_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
         return GM_pop();
     }
   }
-  return simple_menu_handler(msg, i, EXIT__NUM__, &sm, &cur);
+  return simple_menu_handler(msg, i, EXIT__NUM__, &smenu, &cur);
 }
 
 static int main_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
@@ -419,7 +423,7 @@ static int main_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
     { options_menu_handler},
     { exit_menu_handler }
   };
-  static const simple_menu_t sm = {
+  static const simple_menu_t smenu = {
     GM_BIG, "Menu", NULL,
     {
       { "New Game", &hm[NEWGAME] },
@@ -430,7 +434,7 @@ static int main_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
     }
   };
   assert(i >= 0 && i < MAIN__NUM__);
-  return simple_menu_handler(msg, i, MAIN__NUM__, &sm, &cur);
+  return simple_menu_handler(msg, i, MAIN__NUM__, &smenu, &cur);
 }
 
 static const menu_t main_menu = { &main_menu_handler };
@@ -539,6 +543,7 @@ void G_code (void) {
     if(cbuf[30]>='0' && cbuf[30]<='9' && cbuf[31]>='0' && cbuf[31]<='9') {
       g_map=(cbuf[30]=='0')?0:(cbuf[30]-'0')*10;
       g_map+=(cbuf[31]=='0')?0:(cbuf[31]-'0');
+      DEM_stop();
       G_start();
     }
   }else return;
@@ -696,6 +701,11 @@ void GM_input (int ch) {
 void GM_key (int key, int down) {
   int i;
   if (down) {
+#ifdef PROFILER
+    if (key == KEY_F12) {
+      pf_show = !pf_show;
+    }
+#endif
     lastkey = key;
     if (!_2pl || cheat) {
       for (i = 0; i < 31; i++) {
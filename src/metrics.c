@@ -0,0 +1,168 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics.h"
+#include <assert.h>
+#include "error.h" // logo
+
+static char name[64]; // -metrics: shared memory object name
+
+const cfg_t *MT_args (void) {
+  static const cfg_t args[] = {
+    { "metrics", name, Y_STRING, sizeof(name) },
+    { NULL, NULL, 0 } // end
+  };
+  return args;
+}
+
+#ifdef METRICS
+
+#include <stdlib.h> // atexit
+#include <string.h>
+#include <time.h>
+#include <fcntl.h> // O_CREAT
+#include <unistd.h> // ftruncate getpid
+#include <sys/mman.h> // shm_open mmap
+#include "common/wadres.h" // WADRES_lockedsize
+#include "world.h" // world mn_live wp_live dot_live sm_live fx_live it_live g_time
+#include "live.h" // LV_count
+#include "prof.h" // PF_last PF_name
+#include "frame.h" // FR_last
+#include "render.h" // R_atlas_pages
+#include "sound.h" // S_playing
+
+static mt_page_t *page; // NULL if disabled
+static world_t *owner; // other worlds (bench -threads) are not published
+static unsigned long long start; // ns
+
+static unsigned long long nanotime (void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  return clock() * (1000000000ULL / CLOCKS_PER_SEC);
+#endif
+}
+
+static void MT_done (void) {
+  if (page != NULL) {
+    munmap(page, sizeof(mt_page_t));
+    shm_unlink(name);
+    page = NULL;
+  }
+}
+
+void MT_init (void) {
+  int fd;
+  void *p;
+  if (name[0] == 0) {
+    return;
+  }
+  if (name[0] != '/') {
+    memmove(name + 1, name, sizeof(name) - 2);
+    name[sizeof(name) - 1] = 0;
+    name[0] = '/';
+  }
+  fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    logo("MT_init: can't create %s\n", name);
+    return;
+  }
+  p = MAP_FAILED;
+  if (ftruncate(fd, sizeof(mt_page_t)) == 0) {
+    p = mmap(NULL, sizeof(mt_page_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (p == MAP_FAILED) {
+    logo("MT_init: can't map %s\n", name);
+    shm_unlink(name);
+    return;
+  }
+  page = p;
+  memset(page, 0, sizeof(mt_page_t));
+  page->magic = MT_MAGIC;
+  page->version = MT_VERSION;
+  page->pid = getpid();
+#ifdef PROFILER
+  {
+    int i;
+    for (i = 0; i < PF__LAST && i < MT_STAGES; i++) {
+      strncpy(page->stage_name[i], PF_name(i), sizeof(page->stage_name[i]));
+    }
+    page->stages = i;
+  }
+#endif
+  owner = world;
+  atexit(MT_done);
+  logo("MT_init: metrics in %s\n", name);
+}
+
+void MT_begin (void) {
+  if (page != NULL) {
+    start = nanotime();
+  }
+}
+
+void MT_tick (void) {
+  int i;
+  dword seq;
+  dword live[MT__LAST];
+  dword stage_ns[MT_STAGES];
+  dword ns, frame_us, bytes, pages, channels;
+  if (page == NULL || world != owner) {
+    return;
+  }
+  ns = nanotime() - start;
+  /* collect first, readers retry for as long as the page is odd */
+  live[MT_MN] = LV_count(mn_live, MAXMN);
+  live[MT_WP] = LV_count(wp_live, MAXWPN);
+  live[MT_DOT] = LV_count(dot_live, MAXDOT);
+  live[MT_SM] = LV_count(sm_live, MAXSMOK);
+  live[MT_FX] = LV_count(fx_live, MAXFX);
+  live[MT_IT] = LV_count(it_live, MAXITEM);
+  for (i = 0; i < (int)page->stages; i++) {
+#ifdef PROFILER
+    stage_ns[i] = PF_last(i);
+#endif
+  }
+  frame_us = FR_last();
+  bytes = WADRES_lockedsize();
+  pages = R_atlas_pages();
+  channels = S_playing();
+  /* seqlock: odd while writing, the fence keeps data stores after it */
+  seq = page->seq;
+  __atomic_store_n(&page->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  page->tick = g_time;
+  page->tick_ns = ns;
+  page->frame_us = frame_us;
+  memcpy(page->stage_ns, stage_ns, page->stages * sizeof(stage_ns[0]));
+  memcpy(page->live, live, sizeof(live));
+  page->wadres_bytes = bytes;
+  page->atlas_pages = pages;
+  page->channels = channels;
+  __atomic_store_n(&page->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+#else
+
+void MT_init (void) {
+  if (name[0] != 0) {
+    logo("MT_init: built without metrics\n");
+  }
+}
+
+#endif /* METRICS */
@@ -0,0 +1,67 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_H_INCLUDED
+#define METRICS_H_INCLUDED
+
+#include "glob.h"
+#include "system.h" // cfg_t
+
+/*
+ * Live metrics page for external monitoring. With -metrics <name> the
+ * game creates POSIX shared memory object <name> and rewrites the page
+ * after every tick. Readers map it read-only and never block the game:
+ * seq is odd while the page is being written, a copy is consistent when
+ * seq was even and unchanged before and after it (see metrics/main.c).
+ */
+
+#define MT_MAGIC 0x544D3244 // "D2MT", demos use "D2DM"
+#define MT_VERSION 1
+#define MT_STAGES 16 // >= PF__LAST
+
+enum { MT_MN, MT_WP, MT_DOT, MT_SM, MT_FX, MT_IT, MT__LAST };
+
+typedef struct mt_page_t {
+  dword magic, version;
+  dword seq;
+  dword pid;
+  dword tick; // g_time
+  dword tick_ns; // last G_act
+  dword frame_us; // between last two frames, 0 if nothing is drawn
+  dword stages; // stage timings filled, 0 if built without PROFILER
+  char stage_name[MT_STAGES][8];
+  dword stage_ns[MT_STAGES];
+  dword live[MT__LAST]; // entities in use per pool
+  dword wadres_bytes; // locked resources
+  dword atlas_pages;
+  dword channels; // sound channels playing
+} mt_page_t;
+
+const cfg_t *MT_args (void);
+void MT_init (void); // create the page if -metrics given
+
+#ifdef METRICS
+
+void MT_begin (void); // G_act starts
+void MT_tick (void); // G_act done, publish
+
+#else
+
+#  define MT_begin()
+#  define MT_tick()
+
+#endif /* METRICS */
+
+#endif /* METRICS_H_INCLUDED */
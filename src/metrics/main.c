@@ -0,0 +1,133 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Live metrics reader.
+ * Maps the page published by doom2d -metrics <name> read-only and prints
+ * one line per sample. The game never waits for readers: a torn copy is
+ * detected by the sequence number and simply taken again.
+ */
+
+#include <stdio.h>
+#include <stdlib.h> // atoi exit
+#include <string.h>
+#include <time.h> // nanosleep
+#include <fcntl.h> // O_RDONLY
+#include <unistd.h> // close
+#include <sys/mman.h> // shm_open mmap
+#include "metrics.h" // mt_page_t
+
+#define TRIES 1000 // copies before giving up on a busy page
+
+static const char *names[MT__LAST] = { "mn", "wp", "dot", "sm", "fx", "it" };
+
+static void usage (const char *prog) {
+  fprintf(stderr, "usage: %s [-i ms] [-n samples] [-stages] name\n", prog);
+  exit(2);
+}
+
+/* seqlock read side, 0 if the game kept writing the whole time */
+static int sample (const volatile mt_page_t *page, mt_page_t *out) {
+  int i;
+  dword s0, s1;
+  for (i = 0; i < TRIES; i++) {
+    s0 = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+    if ((s0 & 1) == 0) {
+      memcpy(out, (const void *)page, sizeof(mt_page_t));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      s1 = __atomic_load_n(&page->seq, __ATOMIC_RELAXED);
+      if (s0 == s1) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static void print (const mt_page_t *m, int stages) {
+  int i;
+  printf("tick %u  g_act %.3f ms  frame %.2f ms", m->tick, m->tick_ns / 1e6, m->frame_us / 1e3);
+  for (i = 0; i < MT__LAST; i++) {
+    printf("  %s %u", names[i], m->live[i]);
+  }
+  printf("  wadres %u kb  atlas %u  snd %u\n", m->wadres_bytes / 1024, m->atlas_pages, m->channels);
+  if (stages) {
+    for (i = 0; i < (int)m->stages && i < MT_STAGES; i++) {
+      printf("  %.8s %.3f", m->stage_name[i], m->stage_ns[i] / 1e6);
+    }
+    if (m->stages > 0) {
+      printf(" ms\n");
+    }
+  }
+}
+
+int main (int argc, char **argv) {
+  int i, fd;
+  int interval = 1000; // ms
+  int samples = 0; // forever
+  int stages = 0;
+  char name[64];
+  const char *arg = NULL;
+  void *p;
+  mt_page_t m;
+  struct timespec ts;
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      interval = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      samples = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-stages") == 0) {
+      stages = 1;
+    } else if (argv[i][0] != '-' && arg == NULL) {
+      arg = argv[i];
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (arg == NULL) {
+    usage(argv[0]);
+  }
+  snprintf(name, sizeof(name), "%s%s", arg[0] == '/' ? "" : "/", arg);
+  fd = shm_open(name, O_RDONLY, 0);
+  if (fd == -1) {
+    fprintf(stderr, "%s: can't open %s\n", argv[0], name);
+    return 1;
+  }
+  p = mmap(NULL, sizeof(mt_page_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr, "%s: can't map %s\n", argv[0], name);
+    return 1;
+  }
+  if (!sample(p, &m) || m.magic != MT_MAGIC || m.version != MT_VERSION) {
+    fprintf(stderr, "%s: %s is not a metrics page of this version\n", argv[0], name);
+    return 1;
+  }
+  ts.tv_sec = interval / 1000;
+  ts.tv_nsec = interval % 1000 * 1000000L;
+  for (i = 0; samples == 0 || i < samples; i++) {
+    if (i > 0) {
+      nanosleep(&ts, NULL);
+    }
+    if (sample(p, &m)) {
+      print(&m, stages);
+    } else {
+      printf("busy\n");
+    }
+    fflush(stdout);
+  }
+  munmap(p, sizeof(mt_page_t));
+  return 0;
+}
@@ -35,14 +35,73 @@ enum {
   Z_BLOCK = 128
 };
 
-extern byte z_dot;
-extern byte z_mon;
+/* fldt bits, Z_D* are the same for dots which pass through VTRAP walls */
+enum {
+  ZT_SOLID = 1, // wall, closed door
+  ZT_DSOLID = 2,
+  ZT_STAND = 4, // can stand on: walls, doors, steps
+  ZT_DSTAND = 8,
+  ZT_WATER = 16, // water and acid
+  ZT_ACID1 = 32,
+  ZT_ACID2 = 64,
+  ZT_LIFTUP = 128,
+  ZT_LIFTDOWN = 256,
+  ZT_BLOCK = 512, // monsters only
+  ZT_TRAP = 1024, // closing door
+  ZT_AIR = 2048 // can breathe
+};
+
+/* fldr rows, one bit per column */
+enum { ZR_SOLID, ZR_DSOLID, ZR_STAND, ZR_DSTAND, ZR_WATER, ZR_LIFT, ZR_BLOCK, ZR_TRAP, ZR__LAST };
+
+#define ZR_WORDS 2 // FLDW <= 128
+
+/* Z_cansee: flds caps cells to the nearest wall, z_seen remembers rays */
+#define ZS_FAR 4 // 32 pixel bmap cell is 4 samples long
+#define ZS_SEEN 256
+
+/* Z_open: fldo caps cells to the nearest one Z_moveobj could run into */
+#define ZO_FAR 8
+#define ZO_MASK (ZT_STAND | ZT_WATER | ZT_LIFTUP | ZT_LIFTDOWN | ZT_BLOCK)
+
+#define MAX_YV 30 // Z_moveobj gravity stops here
+
+typedef struct {
+  int x, y, xd, yd;
+  dword gen; // of z_seegen, 0 is empty
+  byte r;
+} z_seen_t;
+
+/* what an object box is in, see Z_env */
+typedef struct {
+  int x, y, r, h;
+  dword gen; // of z_envgen, 0 is empty
+  byte lift; // Z_inlift
+  byte water, front; // Z_inwater and fldf of that cell
+  byte acid; // Z_getacid
+  byte air; // Z_canbreathe
+} z_env_t;
+
+#define Z_SNDQ 32 // different samples one tick may queue
+
+typedef struct {
+  void *s; // snd_t
+  int v;
+} z_snd_t;
 
 int Z_sign (int a);
 int Z_dec (int a, int b);
 void *Z_getsnd (char n[6]);
 int Z_sound (void *s, int v);
+void Z_holdsnd (void); // G_act, Z_sound queues from here
+void Z_flushsnd (void); // G_act, plays the queue and stops queueing
 void Z_initst (void);
+void Z_remaptiles (void);
+void Z_retile (int x0, int y0, int x1, int y1);
+int Z_nextcell (int k, int y, int x0, int x1);
+void Z_unsee (void);
+int Z_traps (int *x0, int *y0, int *x1, int *y1);
+int Z_open (int x, int y, int r, int h);
 int Z_canstand (int x, int y, int r);
 int Z_canfit (int x, int y, int r, int h);
 int Z_istrapped (int x, int y, int r, int h);
@@ -50,10 +109,13 @@ void Z_set_speed (obj_t *o, int s);
 int Z_inwater (int x, int y, int r, int h);
 int Z_getacid (int x, int y, int r, int h);
 int Z_canbreathe (int x, int y, int r, int h);
+const z_env_t *Z_env (z_env_t *e, int x, int y, int r, int h);
 int Z_overlap (obj_t *a, obj_t *b);
 int Z_cansee (int x, int y, int xd, int yd);
 int Z_look (obj_t *a, obj_t *b, int d);
-int Z_moveobj (obj_t *p);
+int Z_moveobj (obj_t *p, z_env_t *e); // players, items, weapons
+int Z_movemon (obj_t *p, z_env_t *e); // also stopped by ZT_BLOCK
+int Z_movedot (obj_t *p, z_env_t *e, int o); // 0 wide, 1 high, through VTRAP walls, o of Z_open
 void Z_splash (obj_t *p, int n);
 void Z_calc_time(dword t, word *h, word *m, word *s);
 
@@ -20,6 +20,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
+#include <assert.h>
 #include "files.h"
 #include "memory.h"
 #include "sound.h"
@@ -29,16 +30,14 @@
 #include "monster.h"
 #include "misc.h"
 #include "render.h"
+#include "world.h"
+#include "error.h" // ERR_fatal
 
 //#define WD 200
 //#define HT 98
 
-#define MAX_YV 30
-
-byte z_dot;
-byte z_mon;
 static void *bulsnd[2];
-static byte wfront;
+static W_THREAD byte wfront;
 
 int Z_sign(int a) {
   if(a>0) return 1;
@@ -61,9 +60,32 @@ void *Z_getsnd(char n[6]) {
   return S_load(s);
 }
 
+/*
+ * Inside the simulation sounds wait for the end of the tick: a sample
+ * played many times in one tick takes a single channel, at the loudest
+ * volume asked. Menus play at once.
+ */
 int Z_sound (void *s, int v) {
+  int i;
+  z_snd_t *q;
   if (s != NULL) {
-    S_play(s, 0, v);
+    if (world != NULL && world->z_sndhold) {
+      q = world->z_snd;
+      for (i = 0; i < world->z_sndn && q[i].s != s; i++) {
+        // find
+      }
+      if (i < world->z_sndn) {
+        q[i].v = max(q[i].v, v);
+      } else if (i < Z_SNDQ) {
+        q[i].s = s;
+        q[i].v = v;
+        world->z_sndn += 1;
+      } else {
+        S_play(s, 0, v);
+      }
+    } else {
+      S_play(s, 0, v);
+    }
     // TODO ???
     //S_play(s, -1, 1024, v);
     //return F_getreslen(((int*)s)[-1])/605;
@@ -73,6 +95,19 @@ int Z_sound (void *s, int v) {
   }
 }
 
+void Z_holdsnd (void) {
+  world->z_sndhold = 1;
+}
+
+void Z_flushsnd (void) {
+  int i;
+  for (i = 0; i < world->z_sndn; i++) {
+    S_play(world->z_snd[i].s, 0, world->z_snd[i].v);
+  }
+  world->z_sndn = 0;
+  world->z_sndhold = 0;
+}
+
 #define GAS_START (MN__LAST-MN_DEMON+5)
 #define GAS_TOTAL (MN__LAST-MN_DEMON+16+10)
 
@@ -81,7 +116,231 @@ void Z_initst(void) {
   bulsnd[1]=Z_getsnd("BUL2");
 }
 
-int Z_canstand(int x,int y,int r) {
+static word tile (int x, int y) {
+  word f;
+  int pass = (walf[fldf[y][x]] | walf[fldb[y][x]]) & 2;
+  switch (fld[y][x]) {
+    case 0: case 3: return ZT_AIR;
+    case 1: case 2: f = ZT_SOLID | ZT_STAND; break;
+    case 4: f = ZT_STAND; break;
+    case 5: return ZT_WATER;
+    case 6: return ZT_WATER | ZT_ACID1;
+    case 7: return ZT_WATER | ZT_ACID2;
+    case 8: return ZT_BLOCK;
+    case 9: return ZT_LIFTUP | ZT_AIR;
+    case 10: return ZT_LIFTDOWN | ZT_AIR;
+    case 255: return ZT_TRAP;
+    default: return 0;
+  }
+  if (!pass) {
+    f |= f << 1; // ZT_DSOLID ZT_DSTAND
+  }
+  return f;
+}
+
+static const word rmask[ZR__LAST] = {
+  ZT_SOLID, ZT_DSOLID, ZT_STAND, ZT_DSTAND, ZT_WATER, ZT_LIFTUP | ZT_LIFTDOWN, ZT_BLOCK, ZT_TRAP
+};
+
+static void retile (int x, int y) {
+  int k;
+  word old = fldt[y][x];
+  word f = fldt[y][x] = tile(x, y);
+  uint64_t b = 1ULL << (x & 63);
+  if ((f ^ old) & ZT_TRAP) {
+    if (f & ZT_TRAP) {
+      if (world->z_traps++ == 0) {
+        world->z_tx0 = world->z_tx1 = x;
+        world->z_ty0 = world->z_ty1 = y;
+      }
+      world->z_tx0 = min(world->z_tx0, x); world->z_tx1 = max(world->z_tx1, x);
+      world->z_ty0 = min(world->z_ty0, y); world->z_ty1 = max(world->z_ty1, y);
+    } else {
+      world->z_traps -= 1;
+    }
+  }
+  for (k = 0; k < ZR__LAST; k++) {
+    if (f & rmask[k]) {
+      fldr[k][y][x >> 6] |= b;
+    } else {
+      fldr[k][y][x >> 6] &= ~b;
+    }
+  }
+}
+
+/* chessboard distance to the nearest mask cell up to far, two passes over the box */
+static void clearance (byte f[FLDH][FLDW], word mask, int far, int x0, int y0, int x1, int y1) {
+  int x, y, d;
+  x0 = max(x0, 0); x1 = min(x1, FLDW - 1);
+  y0 = max(y0, 0); y1 = min(y1, FLDH - 1);
+  for (y = y0; y <= y1; y++) {
+    for (x = x0; x <= x1; x++) {
+      d = far - 1;
+      if (fldt[y][x] & mask) {
+        d = -1;
+      } else {
+        if (y > 0) {
+          d = min(d, f[y - 1][x]);
+          if (x > 0) d = min(d, f[y - 1][x - 1]);
+          if (x < FLDW - 1) d = min(d, f[y - 1][x + 1]);
+        }
+        if (x > 0) d = min(d, f[y][x - 1]);
+      }
+      f[y][x] = d + 1;
+    }
+  }
+  for (y = y1; y >= y0; y--) {
+    for (x = x1; x >= x0; x--) {
+      d = f[y][x] - 1;
+      if (y < FLDH - 1) {
+        d = min(d, f[y + 1][x]);
+        if (x > 0) d = min(d, f[y + 1][x - 1]);
+        if (x < FLDW - 1) d = min(d, f[y + 1][x + 1]);
+      }
+      if (x < FLDW - 1) d = min(d, f[y][x + 1]);
+      f[y][x] = d + 1;
+    }
+  }
+}
+
+/* walls changed in fld or bmap, forget what Z_cansee saw */
+void Z_unsee (void) {
+  if (++world->z_seegen == 0) {
+    memset(world->z_seen, 0, sizeof(world->z_seen));
+    world->z_seegen = 1;
+  }
+}
+
+/* whole map, after it was loaded or restored */
+void Z_remaptiles (void) {
+  int x, y;
+  memset(fldt, 0, sizeof(fldt));
+  memset(fldr, 0, sizeof(fldr));
+  world->z_traps = 0;
+  for (y = 0; y < FLDH; y++) {
+    for (x = 0; x < FLDW; x++) {
+      retile(x, y);
+    }
+  }
+  clearance(flds, ZT_SOLID, ZS_FAR, 0, 0, FLDW - 1, FLDH - 1);
+  clearance(fldo, ZO_MASK, ZO_FAR, 0, 0, FLDW - 1, FLDH - 1);
+  world->z_envgen++;
+  memset(world->z_seen, 0, sizeof(world->z_seen));
+  world->z_seegen = 1;
+}
+
+/* cells x0..x1, y0..y1 changed in fld, fldf or fldb */
+void Z_retile (int x0, int y0, int x1, int y1) {
+  int x, y;
+  assert(x0 >= 0 && x0 <= x1 && x1 < FLDW);
+  assert(y0 >= 0 && y0 <= y1 && y1 < FLDH);
+  for (y = y0; y <= y1; y++) {
+    for (x = x0; x <= x1; x++) {
+      retile(x, y);
+    }
+  }
+  // farther cells stay at ZS_FAR either way
+  clearance(flds, ZT_SOLID, ZS_FAR, x0 - ZS_FAR + 1, y0 - ZS_FAR + 1, x1 + ZS_FAR - 1, y1 + ZS_FAR - 1);
+  clearance(fldo, ZO_MASK, ZO_FAR, x0 - ZO_FAR + 1, y0 - ZO_FAR + 1, x1 + ZO_FAR - 1, y1 + ZO_FAR - 1);
+  world->z_envgen++;
+  Z_unsee();
+}
+
+/* columns a..b of one row word, 0 <= a <= b < 64 */
+static uint64_t span (int a, int b) {
+  return (~0ULL >> (63 - (b - a))) << a;
+}
+
+/* any bit set in columns a..b, 0 <= a <= b < FLDW */
+static int rowhit (const uint64_t *r, int a, int b) {
+  int w;
+  for (w = a >> 6; w <= b >> 6; w++) {
+    if (r[w] & span(w == a >> 6 ? a & 63 : 0, w == b >> 6 ? b & 63 : 63)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* leftmost column set in a..b or -1 */
+static int rowfirst (const uint64_t *r, int a, int b) {
+  int w;
+  uint64_t m;
+  for (w = a >> 6; w <= b >> 6; w++) {
+    m = r[w] & span(w == a >> 6 ? a & 63 : 0, w == b >> 6 ? b & 63 : 63);
+    if (m != 0) {
+#ifdef __GNUC__
+      return w * 64 + __builtin_ctzll(m);
+#else
+      int i = 0;
+      while (!(m & 1)) {
+        m >>= 1;
+        i++;
+      }
+      return w * 64 + i;
+#endif
+    }
+  }
+  return -1;
+}
+
+/* leftmost cell in the box, topmost of that column, like a column by column scan */
+static int boxfirst (int k, int sx, int sy, int x, int y, int *cx, int *cy) {
+  int j, c, found = 0;
+  for (j = sy; j <= y && sx <= x; ++j) {
+    if ((c = rowfirst(fldr[k][j], sx, x)) >= 0) {
+      *cx = c;
+      *cy = j;
+      found = 1;
+      x = c - 1; // only a column further left can win now
+    }
+  }
+  return found;
+}
+
+/* leftmost column of row y in fldr[k] between x0 and x1 or -1 */
+int Z_nextcell (int k, int y, int x0, int x1) {
+  assert(y >= 0 && y < FLDH);
+  assert(x0 >= 0 && x0 <= x1 && x1 < FLDW);
+  return rowfirst(fldr[k][y], x0, x1);
+}
+
+/* pixels covered by trap cells, box only grows until they are all gone */
+int Z_traps (int *x0, int *y0, int *x1, int *y1) {
+  if (world->z_traps <= 0) {
+    return 0;
+  }
+  *x0 = world->z_tx0 * CELW;
+  *y0 = world->z_ty0 * CELH;
+  *x1 = world->z_tx1 * CELW + CELW - 1;
+  *y1 = world->z_ty1 * CELH + CELH - 1;
+  return 1;
+}
+
+/* cells the box can move and still stay off ZO_MASK cells, or -1 */
+int Z_open(int x,int y,int r,int h) {
+  int e;
+
+  if(x<0 || x>=FLDW*CELW || y<0 || y>=FLDH*CELH) return -1;
+  e=max((r+CELW-1)/CELW,(h+CELH-2)/CELH);
+  if(e<1) e=1; // Z_canstand row
+  return fldo[y/CELH][x/CELW]-1-e;
+}
+
+/* Z_moveobj kinds, always constant so each one gets its own inlined copy */
+enum { ZK_OBJ, ZK_MON, ZK_DOT };
+
+#ifdef __GNUC__
+#  define Z_KERNEL static inline __attribute__((always_inline))
+#else
+#  define Z_KERNEL static inline
+#endif
+
+/* dots pass through VTRAP walls */
+#define ZK_SOLID(kind) ((kind)==ZK_DOT?ZR_DSOLID:ZR_SOLID)
+#define ZK_STAND(kind) ((kind)==ZK_DOT?ZR_DSTAND:ZR_STAND)
+
+Z_KERNEL int canstand(int x,int y,int r,int k) {
   int i;
 
   i=(x-r)/CELW;
@@ -90,14 +349,15 @@ int Z_canstand(int x,int y,int r) {
   if(y>=FLDH || y<0) return 0;
   if(i<0) i=0;
   if(x>=FLDW) x=FLDW-1;
-  for(;i<=x;++i)
-    if(fld[y][i]==1 || fld[y][i]==2 || fld[y][i]==4)
-      if(!z_dot) return 1;
-      else if(!((walf[fldf[y][i]]|walf[fldb[y][i]])&2)) return 1;
-  return 0;
+  if(i>x) return 0;
+  return rowhit(fldr[k][y],i,x);
 }
 
-static int Z_hitceil(int x,int y,int r,int h) {
+int Z_canstand(int x,int y,int r) {
+  return canstand(x,y,r,ZR_STAND);
+}
+
+Z_KERNEL int hitceil(int x,int y,int r,int h,int k) {
   int i;
 
   i=(x-r)/CELW;
@@ -106,15 +366,12 @@ static int Z_hitceil(int x,int y,int r,int h) {
   if(y>=FLDH || y<0) return 0;
   if(i<0) i=0;
   if(x>=FLDW) x=FLDW-1;
-  for(;i<=x;++i)
-    if(fld[y][i]==1 || fld[y][i]==2)
-      if(!z_dot) return 1;
-      else if(!((walf[fldf[y][i]]|walf[fldb[y][i]])&2)) return 1;
-  return 0;
+  if(i>x) return 0;
+  return rowhit(fldr[k][y],i,x);
 }
 
-int Z_canfit(int x,int y,int r,int h) {
-  int i,j,sx,sy;
+Z_KERNEL int canfit(int x,int y,int r,int h,int k) {
+  int j,sx,sy;
 
   sx=(x-r)/CELW;
   sy=(y-h+1)/CELH;
@@ -124,16 +381,18 @@ int Z_canfit(int x,int y,int r,int h) {
   y=(y-0)/CELH;
   if(x>=FLDW) x=FLDW-1;
   if(y>=FLDH) y=FLDH-1;
-  for(i=sx;i<=x;++i)
-    for(j=sy;j<=y;++j)
-      if(fld[j][i]==1 || fld[j][i]==2)
-        if(!z_dot) return 0;
-        else if(!((walf[fldf[j][i]]|walf[fldb[j][i]])&2)) return 0;
+  if(sx>x) return 1;
+  for(j=sy;j<=y;++j)
+    if(rowhit(fldr[k][j],sx,x)) return 0;
   return 1;
 }
 
+int Z_canfit(int x,int y,int r,int h) {
+  return canfit(x,y,r,h,ZR_SOLID);
+}
+
 static int Z_inlift(int x,int y,int r,int h) {
-  int i,j,sx,sy;
+  int sx,sy,cx,cy;
 
   sx=(x-r)/CELW;
   sy=(y-h+1)/CELH;
@@ -143,9 +402,7 @@ static int Z_inlift(int x,int y,int r,int h) {
   y=(y-1)/CELH;
   if(x>=FLDW) x=FLDW-1;
   if(y>=FLDH) y=FLDH-1;
-  for(i=sx;i<=x;++i)
-	for(j=sy;j<=y;++j)
-	  if(fld[j][i]==9 || fld[j][i]==10) return fld[j][i]-8;
+  if(boxfirst(ZR_LIFT,sx,sy,x,y,&cx,&cy)) return fldt[cy][cx]&ZT_LIFTUP?1:2;
   return 0;
 }
 
@@ -164,7 +421,7 @@ static int Z_isblocked(int x,int y,int r,int h,int xv) {
   if(y>=FLDH) y=FLDH-1;
   for(i=sx;i<=x;++i)
 	for(j=sy;j<=y;++j)
-	  if(fld[j][i]==8) return 1;
+	  if(fldt[j][i]&ZT_BLOCK) return 1;
   return 0;
 }
 
@@ -181,7 +438,7 @@ int Z_istrapped(int x,int y,int r,int h) {
   if(y>=FLDH) y=FLDH-1;
   for(i=sx;i<=x;++i)
     for(j=sy;j<=y;++j)
-	  if(fld[j][i]==255) return 1;
+	  if(fldt[j][i]&ZT_TRAP) return 1;
   return 0;
 }
 
@@ -193,7 +450,7 @@ void Z_set_speed(obj_t *o,int s) {
 }
 
 int Z_inwater(int x,int y,int r,int h) {
-  int i,j,sx,sy;
+  int sx,sy,cx,cy;
 
   sx=(x-r)/CELW;
   sy=(y-h+1)/CELH;
@@ -203,9 +460,7 @@ int Z_inwater(int x,int y,int r,int h) {
   y=(y-h/2)/CELH;
   if(x>=FLDW) x=FLDW-1;
   if(y>=FLDH) y=FLDH-1;
-  for(i=sx;i<=x;++i)
-	for(j=sy;j<=y;++j)
-	  if(fld[j][i]>=5 && fld[j][i]<=7) {wfront=fldf[j][i];return 1;}
+  if(boxfirst(ZR_WATER,sx,sy,x,y,&cx,&cy)) {wfront=fldf[cy][cx];return 1;}
   return 0;
 }
 
@@ -224,9 +479,8 @@ int Z_getacid(int x,int y,int r,int h) {
   if(y>=FLDH) y=FLDH-1;
   for(i=sx;i<=x;++i)
 	for(j=sy;j<=y;++j)
-	  if(fld[j][i]==6) a|=1;
-	  else if(fld[j][i]==7) a|=2;
-  return tab[a];
+	  a|=fldt[j][i];
+  return tab[(a&(ZT_ACID1|ZT_ACID2))/ZT_ACID1];
 }
 
 int Z_canbreathe(int x,int y,int r,int h) {
@@ -243,10 +497,55 @@ int Z_canbreathe(int x,int y,int r,int h) {
   if(sx>x || sy>y) return 1;
   for(i=sx;i<=x;++i)
     for(j=sy;j<=y;++j)
-      if(fld[j][i]==0 || fld[j][i]==3 || fld[j][i]==9 || fld[j][i]==10) return 1;
+      if(fldt[j][i]&ZT_AIR) return 1;
   return 0;
 }
 
+/* Z_inlift, Z_inwater, Z_getacid and Z_canbreathe in one pass */
+static void scan(z_env_t *e,int x,int y,int r,int h) {
+  static const byte tab[4]={0,5,10,20};
+  int i,j,sx,sy,yl,yw,a;
+  word f;
+
+  e->x=x;e->y=y;e->r=r;e->h=h;
+  e->gen=world->z_envgen;
+  e->lift=e->water=e->front=0;
+  sx=(x-r)/CELW;
+  sy=(y-h+1)/CELH;
+  if(sx<0) sx=0;
+  if(sy<0) sy=0;
+  x=(x+r)/CELW;
+  yl=(y-1)/CELH;
+  yw=(y-h/2)/CELH;
+  y=y/CELH;
+  if(x>=FLDW) x=FLDW-1;
+  if(yl>=FLDH) yl=FLDH-1;
+  if(yw>=FLDH) yw=FLDH-1;
+  if(y>=FLDH) y=FLDH-1;
+  e->air=(sx>x || sy>yw);
+  a=0;
+  // column by column like boxfirst, lifts and water take the first cell
+  for(i=sx;i<=x;++i)
+	for(j=sy;j<=y;++j) {
+	  a|=f=fldt[j][i];
+	  if(j<=yl && !e->lift && (f&(ZT_LIFTUP|ZT_LIFTDOWN)))
+		e->lift=f&ZT_LIFTUP?1:2;
+	  if(j<=yw) {
+		if(!e->water && (f&ZT_WATER)) {e->water=1;e->front=fldf[j][i];}
+		if(f&ZT_AIR) e->air=1;
+	  }
+	}
+  e->acid=tab[(a&(ZT_ACID1|ZT_ACID2))/ZT_ACID1];
+}
+
+/* e describes the box, scanned again only when the box or tiles changed */
+const z_env_t *Z_env(z_env_t *e,int x,int y,int r,int h) {
+  if(e->gen!=world->z_envgen || e->x!=x || e->y!=y || e->r!=r || e->h!=h)
+	scan(e,x,y,r,h);
+  if(e->water) wfront=e->front;
+  return e;
+}
+
 int Z_overlap(obj_t *a,obj_t *b) {
   if(a->x - a->r > b->x + b->r) return 0;
   if(a->x + a->r < b->x - b->r) return 0;
@@ -264,7 +563,7 @@ static void Z_kickobj(obj_t *o,int x,int y,int pwr) {
   o->vy+=(long)dy*pwr/m;
 }
 
-int Z_cansee(int x,int y,int xd,int yd) {
+static int ray(int x,int y,int xd,int yd) {
   register dword d,m;
   int sx,sy;
   dword xe,ye,s,i;
@@ -281,28 +580,39 @@ int Z_cansee(int x,int y,int xd,int yd) {
   for(i=0;i<=d;) {
 	if(x<0 || x>=FLDW*8 || y<0 || y>=FLDH*8) return 0;
 	if((bmap[y>>5][x>>5]&BM_WALL)) {
-	  if(fld[y>>3][x>>3]==1 || fld[y>>3][x>>3]==2) return 0;
-	  if((xe+=(xd<<3))>=d) {
-		x+=xe/d*sx;xe=xe%d;
-	  }
-	  if((ye+=(yd<<3))>=d) {
-		y+=ye/d*sy;ye=ye%d;
-	  }
-	  i+=8;
+	  if(fldt[y>>3][x>>3]&ZT_SOLID) return 0;
+	  // samples are at most 8 pixels apart on both axes: skip those
+	  // which can't reach a wall and stay in this bmap cell
+	  m=flds[y>>3][x>>3]-1;
+	  if(sx) {s=x&31;if(sx>0) s^=31;if(s/8<m) m=s/8;}
+	  if(sy) {s=y&31;if(sy>0) s^=31;if(s/8<m) m=s/8;}
+	  m=(m+1)<<3;
 	}else{
 	  if(sx==0) m=0;
 	  else{m=x&31;if(sx>0) m^=31; ++m;}
 	  if(sy==0) s=0;
 	  else{s=y&31;if(sy>0) s^=31; ++s;}
 	  if((s<m && s!=0) || m==0) m=s;
-	  i+=m;
-		x+=(xd*m+xe)/d*sx;xe=(xd*m+xe)%d;
-		y+=(yd*m+ye)/d*sy;ye=(yd*m+ye)%d;
 	}
+	i+=m;
+	x+=(xd*m+xe)/d*sx;xe=(xd*m+xe)%d;
+	y+=(yd*m+ye)/d*sy;ye=(yd*m+ye)%d;
   }
   return 1;
 }
 
+int Z_cansee(int x,int y,int xd,int yd) {
+  z_seen_t *p;
+
+  p=&world->z_seen[((dword)x*7+(dword)y*31+(dword)xd*131+(dword)yd*1031)%ZS_SEEN];
+  if(p->gen!=world->z_seegen || p->x!=x || p->y!=y || p->xd!=xd || p->yd!=yd) {
+	p->x=x;p->y=y;p->xd=xd;p->yd=yd;
+	p->gen=world->z_seegen;
+	p->r=ray(x,y,xd,yd);
+  }
+  return p->r;
+}
+
 int Z_look(obj_t *a,obj_t *b,int d) {
   if(Z_sign(b->x-a->x)!=d*2-1) return 0;
   return Z_cansee(a->x,a->y-a->h/2,b->x,b->y-b->h/2);
@@ -310,40 +620,18 @@ int Z_look(obj_t *a,obj_t *b,int d) {
 
 #define wvel(v) if((xv=abs(v)+1)>5) v=Z_dec(v,xv/2-2)
 
-int Z_moveobj(obj_t *p) {
-  static int x,y,xv,yv,r,h,lx,ly,st;
-  static byte inw;
+/* 7 pixel steps, the reference for sweep */
+Z_KERNEL int steps(obj_t *p,int *px,int *py,int r,int h,int xv,int yv,int kind) {
+  int x=*px,y=*py,lx,ly,st=0;
 
-  st=0;
-  switch(Z_inlift(x=p->x,y=p->y,r=p->r,h=p->h)) {
-    case 0:
-      if(++p->yv>MAX_YV) --p->yv;
-      break;
-    case 1:
-      if(--p->yv < -5) ++p->yv;
-      break;
-    case 2:
-      if(p->yv > 5) {--p->yv;break;}
-      ++p->yv;break;
-  }
-  if((inw=Z_inwater(x,y,r,h))!=0) {
-	st|=Z_INWATER;
-	wvel(p->xv);
-	wvel(p->yv);
-	wvel(p->vx);
-	wvel(p->vy);
-  }
-  p->vx=Z_dec(p->vx,1);
-  p->vy=Z_dec(p->vy,1);
-  xv=p->xv+p->vx;yv=p->yv+p->vy;
   while(xv || yv) {
 	if(x<-100 || x>=FLDW*8+100 || y<-100 || y>=FLDH*8+100)
 	  {st|=Z_FALLOUT;}
 
 	lx=x;
 	x+=(abs(xv)<=7)?xv:((xv>0)?7:-7);
-	if(z_mon) if(Z_isblocked(x,y,r,h,xv)) st|=Z_BLOCK;
-	if(!Z_canfit(x,y,r,h)) {
+	if(kind==ZK_MON) if(Z_isblocked(x,y,r,h,xv)) st|=Z_BLOCK;
+	if(!canfit(x,y,r,h,ZK_SOLID(kind))) {
 	  if(xv==0) x=lx;
 	  else if(xv<0) x=((lx-r)&0xFFF8)+r;
           else x=((lx+r)&0xFFF8)-r+7;
@@ -354,24 +642,127 @@ int Z_moveobj(obj_t *p) {
 	ly=y;
 	y+=(abs(yv)<=7)?yv:((yv>0)?7:-7);
 	if(yv>=8) --y;
-	if(yv<0 && Z_hitceil(x,y,r,h)) {
+	if(yv<0 && hitceil(x,y,r,h,ZK_SOLID(kind))) {
 	  y=((ly-h+1)&0xFFF8)+h-1;
 	  yv=p->vy=1;p->yv=0;st|=Z_HITCEIL;
 	}
-	if(yv>0 && Z_canstand(x,y,r)) {
+	if(yv>0 && canstand(x,y,r,ZK_STAND(kind))) {
 	  y=((y+1)&0xFFF8)-1;
 	  yv=p->yv=p->vy=0;st|=Z_HITLAND;
 	}
 	yv-=(abs(yv)<=7)?yv:((yv>0)?7:-7);
   }
+  *px=x;*py=y;
+  return st;
+}
+
+/* the same steps in one go: box around the whole path against the row
+   bitsets, 0 if anything is in it and steps has to find what */
+Z_KERNEL int sweep(int x,int y,int r,int h,int xv,int yv,int *px,int *py,int kind) {
+  int x0=x,y0=y,x1=x,y1=y,d,j,down=0;
+
+  while(xv || yv) {
+	d=(abs(xv)<=7)?xv:((xv>0)?7:-7);
+	x+=d;xv-=d;
+	if(yv>0) down=1;
+	d=(abs(yv)<=7)?yv:((yv>0)?7:-7);
+	y+=d;
+	if(yv>=8) --y;
+	yv-=d;
+	x0=min(x0,x);x1=max(x1,x);
+	y0=min(y0,y);y1=max(y1,y);
+  }
+  // inside the map cell math is plain division without clamping
+  if(x0-r<0 || x1+r>=FLDW*CELW || y0-h+1<0 || y1+1>=FLDH*CELH) return 0;
+  x0=(x0-r)/CELW;x1=(x1+r)/CELW;
+  for(j=(y0-h+1)/CELH;j<=y1/CELH;++j) {
+	if(rowhit(fldr[ZK_SOLID(kind)][j],x0,x1)) return 0;
+	if(kind==ZK_MON && rowhit(fldr[ZR_BLOCK][j],x0,x1)) return 0;
+  }
+  if(down) for(j=(y0+1)/CELH;j<=(y1+1)/CELH;++j)
+	if(rowhit(fldr[ZK_STAND(kind)][j],x0,x1)) return 0;
+  *px=x;*py=y;
+  return 1;
+}
+
+/* Z_moveobj, o is Z_open at the start, shortcuts off for SWEEPCHECK */
+Z_KERNEL int move(obj_t *p,z_env_t *e,int fast,int o,int kind) {
+  int x,y,xv,yv,r,h,st,inw,lift;
+
+  st=0;
+  x=p->x;y=p->y;
+  if(kind==ZK_DOT) {r=0;h=1;} // all dots, see DOT_init
+  else {r=p->r;h=p->h;}
+  if(!fast) o=-1;
+  if(o>=0) lift=inw=0;
+  else if(fast) {Z_env(e,x,y,r,h);lift=e->lift;inw=e->water;}
+  else {lift=Z_inlift(x,y,r,h);inw=Z_inwater(x,y,r,h);}
+  switch(lift) {
+    case 0:
+      if(++p->yv>MAX_YV) --p->yv;
+      break;
+    case 1:
+      if(--p->yv < -5) ++p->yv;
+      break;
+    case 2:
+      if(p->yv > 5) {--p->yv;break;}
+      ++p->yv;break;
+  }
+  if(inw) {
+	st|=Z_INWATER;
+	wvel(p->xv);
+	wvel(p->yv);
+	wvel(p->vx);
+	wvel(p->vy);
+  }
+  p->vx=Z_dec(p->vx,1);
+  p->vy=Z_dec(p->vy,1);
+  xv=p->xv+p->vx;yv=p->yv+p->vy;
+  if(o>=(max(abs(xv),abs(yv))+CELW-1)/CELW) {
+	// nothing to run into on the way, where the steps end
+	p->x=x+xv;
+	p->y=y+yv-(yv>=8?(yv-1)/7:0);
+	return st;
+  }
+  // one step costs about as much as the sweep
+  if(!fast || (abs(xv)<=7 && abs(yv)<=7) || !sweep(x,y,r,h,xv,yv,&x,&y,kind)) {
+	st|=steps(p,&x,&y,r,h,xv,yv,kind);
+  }
   p->x=x;p->y=y;
-  if(Z_inwater(x,y,r,h)) {
+  if(fast?Z_env(e,x,y,r,h)->water:Z_inwater(x,y,r,h)) {
 	st|=Z_INWATER;
 	if(!inw) st|=Z_HITWATER;
   }else if(inw) st|=Z_HITAIR;
   return st;
 }
 
+Z_KERNEL int moveas(obj_t *p,z_env_t *e,int o,int kind) {
+#ifdef SWEEPCHECK
+  obj_t q=*p;
+  int st,qs;
+
+  st=move(p,e,1,o,kind);
+  qs=move(&q,NULL,0,-1,kind);
+  if(st!=qs || memcmp(&q,p,sizeof(q)))
+	ERR_fatal("Z_moveobj: ended at %d,%d st %d, 7 pixel steps at %d,%d st %d",p->x,p->y,st,q.x,q.y,qs);
+  return st;
+#else
+  return move(p,e,1,o,kind);
+#endif
+}
+
+int Z_moveobj(obj_t *p,z_env_t *e) {
+  return moveas(p,e,Z_open(p->x,p->y,p->r,p->h),ZK_OBJ);
+}
+
+int Z_movemon(obj_t *p,z_env_t *e) {
+  return moveas(p,e,Z_open(p->x,p->y,p->r,p->h),ZK_MON);
+}
+
+int Z_movedot(obj_t *p,z_env_t *e,int o) {
+  return moveas(p,e,o,ZK_DOT);
+}
+
 void Z_splash (obj_t *p, int n) {
   Z_sound(bulsnd[0], 128);
   DOT_water(p->x, p->y-p->h / 2, p->xv + p->vx, p->yv + p->vy, n, R_get_special_id(wfront) - 1);
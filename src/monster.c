@@ -33,6 +33,9 @@
 #include "player.h"
 #include "error.h"
 #include "game.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
 
 #define MAX_ATM 90
 
@@ -82,9 +85,10 @@ static char *sleepanim[MN_TN]={
   "","U","U","U","","T","","","","","","","","","","","","","","W"
 };
 
-int hit_xv, hit_yv;
-mn_t mn[MAXMN];
-int mnum, gsndt;
+#define pt_x (world->mn_pt_x)
+#define pt_xs (world->mn_pt_xs)
+#define pt_y (world->mn_pt_y)
+#define pt_ys (world->mn_pt_ys)
 
 static void *fsnd,*pauksnd,*trupsnd;
 static void *snd[MN_TN][5],*impsitsnd[2],*impdthsnd[2],*firsnd,*slopsnd,*gsnd[4];
@@ -123,7 +127,7 @@ void setst (int i, int st) {
     case DIE: case DEAD:
       if(st!=DEAD && st!=REVIVE) return;
   }
-  mn[i].ac=0;
+  mnc[i].ac=0;
   t=mn[i].t-1;
   switch(mn[i].st=st) {
 	case SLEEP: a=sleepanim[t];break;
@@ -143,18 +147,19 @@ void setst (int i, int st) {
 	  a=dieanim[t];break;
 	case DEAD:
 	  a=deadanim[t];
-	  if(mn[i].ap==slopanim[t]) a=messanim[t];
-	  if(t==MN_BARREL-1) {mn[i].t=0;}
+	  if(mnc[i].ap==slopanim[t]) a=messanim[t];
+	  if(t==MN_BARREL-1) {mn[i].t=0;LV_put(mn_live,i,0);}
 	  break;
 	case REVIVE:
-	  a=(mn[i].ap==messanim[t])?slopanim[t]:dieanim[t];
-	  mn[i].ac=strlen(a)-1;
+	  a=(mnc[i].ap==messanim[t])?slopanim[t]:dieanim[t];
+	  mnc[i].ac=strlen(a)-1;
 	  mn[i].o.r=mnsz[t+1].r;mn[i].o.h=mnsz[t+1].h;
-	  mn[i].life=mnsz[t+1].l;mn[i].ammo=mn[i].pain=0;
+	  mnc[i].life=mnsz[t+1].l;mnc[i].ammo=mnc[i].pain=0;
 	  ++mnum;
+	  BM_place(i);
 	  break;
   }
-  mn[i].ap=a;
+  mnc[i].ap=a;
 }
 
 #define GGAS_TOTAL (MN__LAST-MN_DEMON+16+10)
@@ -216,6 +221,7 @@ void MN_alloc (void) {
 void MN_init (void) {
   int i;
   for(i=0;i<MAXMN;++i) {mn[i].t=0;mn[i].st=SLEEP;}
+  LV_clear(mn_live,MAXMN);
   gsndt=mnum=0;
 }
 
@@ -223,24 +229,27 @@ int MN_spawn (int x, int y, byte d, int t) {
   int i;
 
   if(g_dm && nomon && t<MN_PL_DEAD) return -1;
-  for(i=0;i<MAXMN;++i) if(!mn[i].t) goto ok;
-  for(i=0;i<MAXMN;++i) if(mn[i].t>=MN_PL_DEAD) goto ok;
+  if((i=LV_free(mn_live,MAXMN))<MAXMN) goto ok;
+  LV_EACH(i,mn_live,MAXMN) if(mn[i].t>=MN_PL_DEAD) goto ok;
   return -1;
 ok:
+  mn_gen[i]=(mn_gen[i]+1)&0x7FFF;
   mn[i].o.x=x;mn[i].o.y=y;
   mn[i].o.xv=mn[i].o.yv=mn[i].o.vx=mn[i].o.vy=0;
   mn[i].d=d;mn[i].t=t;
+  LV_put(mn_live,i,t);
   mn[i].st=SLEEP;
   if(t<MN_PL_DEAD) {
     mn[i].o.r=mnsz[t].r;mn[i].o.h=mnsz[t].h;
-    mn[i].life=mnsz[t].l;
-    setst(i,SLEEP);mn[i].s=myrand(18);
+    mnc[i].life=mnsz[t].l;
+    setst(i,SLEEP);mnc[i].s=RND_mod(RND_MONSTER,18);
     ++mnum;
-  }else {mn[i].o.r=8;mn[i].o.h=6;mn[i].life=0;mn[i].st=DEAD;}
-  mn[i].aim=-3;mn[i].atm=0;
-  mn[i].pain=0;
-  mn[i].ammo=0;
+  }else {mn[i].o.r=8;mn[i].o.h=6;mnc[i].life=0;mn[i].st=DEAD;}
+  mnc[i].aim=-3;mnc[i].atm=0;
+  mnc[i].pain=0;
+  mnc[i].ammo=0;
   mn[i].ftime=0;
+  BM_place(i);
   return i;
 }
 
@@ -248,7 +257,7 @@ int MN_spawn_deadpl (obj_t *o, byte c, int t) {
   int i;
 
   if((i=MN_spawn(o->x,o->y,c,t+MN_PL_DEAD))==-1) return -1;
-  mn[i].o=*o;return i;
+  mn[i].o=*o;BM_place(i);return i;
 }
 
 static int isfriend(int a,int b) {
@@ -272,23 +281,38 @@ static int MN_findnewprey(int i) {
   a=!PL_isdead(&pl1);
   if(_2pl) b=!PL_isdead(&pl2); else b=0;
   if(a) {
-	if(b) mn[i].aim=(abs(mn[i].o.x-pl1.o.x)+abs(mn[i].o.y-pl1.o.y)
+	if(b) mnc[i].aim=(abs(mn[i].o.x-pl1.o.x)+abs(mn[i].o.y-pl1.o.y)
 	    <= abs(mn[i].o.x-pl2.o.x)+abs(mn[i].o.y-pl2.o.y))?-1:-2;
-	else mn[i].aim=-1;
+	else mnc[i].aim=-1;
   }else{
-	if(b) mn[i].aim=-2;
+	if(b) mnc[i].aim=-2;
 	else{
-	  for(a=0,b=32000,mn[i].aim=-3;a<MAXMN;++a)
-	    if(mn[a].t && mn[a].st!=DEAD && a!=i && !isfriend(mn[a].t,mn[i].t))
+	  b=32000;mnc[i].aim=-3;
+	  LV_EACH(a,mn_live,MAXMN)
+	    if(mn[a].st!=DEAD && a!=i && !isfriend(mn[a].t,mn[i].t))
 	      if((l=abs(mn[i].o.x-mn[a].o.x)+abs(mn[i].o.y-mn[a].o.y))<b)
-	        {mn[i].aim=a;b=l;}
-	  if(mn[i].aim<0) {mn[i].atm=MAX_ATM;return 0;} else mn[i].atm=0;
+	        {mnc[i].aim=MN_ref(a);b=l;}
+	  if(mnc[i].aim<0) {mnc[i].atm=MAX_ATM;return 0;} else mnc[i].atm=0;
 	}
   }
   return 1;
 }
 
-int Z_getobjpos (int i, obj_t *o) {
+int MN_ref (int i) {
+  return i<0?i:i|mn_gen[i]<<MN_SLOTBITS;
+}
+
+int MN_slot (int h) {
+  int i;
+
+  if(h<0) return h;
+  i=h&((1<<MN_SLOTBITS)-1);
+  return i<MAXMN && mn_gen[i]==h>>MN_SLOTBITS?i:-3;
+}
+
+int Z_getobjpos (int h, obj_t *o) {
+  int i=MN_slot(h);
+
   if(i==-1) {*o=pl1.o;return !PL_isdead(&pl1);}
   if(_2pl) if(i==-2) {*o=pl2.o;return !PL_isdead(&pl2);}
   if(i>=0 && i<MAXMN) if(mn[i].t && mn[i].st!=DEAD)
@@ -298,18 +322,18 @@ int Z_getobjpos (int i, obj_t *o) {
 
 static void *wakeupsnd(int t) {
   switch(t) {
-	case MN_IMP: return impsitsnd[myrand(2)];
+	case MN_IMP: return impsitsnd[RND_mod(RND_MONSTER,2)];
 	case MN_ZOMBY: case MN_SERG: case MN_CGUN:
-	  return positsnd[myrand(3)];
+	  return positsnd[RND_mod(RND_MONSTER,3)];
   }
   return snd[t-1][3];
 }
 
 static void *dthsnd(int t) {
   switch(t) {
-	case MN_IMP: return impdthsnd[myrand(2)];
+	case MN_IMP: return impdthsnd[RND_mod(RND_MONSTER,2)];
 	case MN_ZOMBY: case MN_SERG: case MN_CGUN:
-	  return podthsnd[myrand(3)];
+	  return podthsnd[RND_mod(RND_MONSTER,3)];
   }
   return snd[t-1][4];
 }
@@ -325,62 +349,62 @@ static int canshoot(int t) {
 static int shoot(int i,obj_t *o,int n) {
   int xd,yd,m;
 
-  if(mn[i].ammo<0) return 0;
+  if(mnc[i].ammo<0) return 0;
   if(!n) switch(mn[i].t) {
 	case MN_FISH: case MN_BARREL:
 	case MN_DEMON: return 0;
 	case MN_CGUN:
 	case MN_BSP:
 	case MN_ROBO:
-	  if(++mn[i].ammo>=50) mn[i].ammo=(mn[i].t==MN_ROBO)?-200:-50;
+	  if(++mnc[i].ammo>=50) mnc[i].ammo=(mn[i].t==MN_ROBO)?-200:-50;
 	  break;
 	case MN_MAN:
 	  break;
 	case MN_MANCUB:
-	  if(++mn[i].ammo>=5) mn[i].ammo=-50;
+	  if(++mnc[i].ammo>=5) mnc[i].ammo=-50;
 	  break;
 	case MN_SPIDER:
-	  if(++mn[i].ammo>=100) mn[i].ammo=-50;
+	  if(++mnc[i].ammo>=100) mnc[i].ammo=-50;
 	  break;
 	case MN_CYBER:
-	  if(rand()&1) return 0;
-	  if(++mn[i].ammo>=10) mn[i].ammo=-50;
+	  if(RND_rand(RND_MONSTER)&1) return 0;
+	  if(++mnc[i].ammo>=10) mnc[i].ammo=-50;
 	  break;
 	case MN_BARON: case MN_KNIGHT:
-	  if(rand()&7) return 0;
+	  if(RND_rand(RND_MONSTER)&7) return 0;
 	  break;
 	case MN_SKEL:
-	  if(rand()&31) return 0;
+	  if(RND_rand(RND_MONSTER)&31) return 0;
 	  break;
 	case MN_VILE:
-	  if(rand()&7) return 0;
+	  if(RND_rand(RND_MONSTER)&7) return 0;
 	  break;
 	case MN_PAIN:
-	  if(rand()&7) return 0;
+	  if(RND_rand(RND_MONSTER)&7) return 0;
 	  break;
 	default:
-	  if(rand()&15) return 0;
+	  if(RND_rand(RND_MONSTER)&15) return 0;
   }
   if(!Z_look(&mn[i].o,o,mn[i].d)) return 0;
-  mn[i].atm=0;
-  mn[i].tx=o->x+(o->xv+o->vx)*6;mn[i].ty=o->y-o->h/2+(o->yv+o->vy)*6;
-  if(abs(mn[i].tx-mn[i].o.x)<abs(mn[i].ty-mn[i].o.y+mn[i].o.h/2)) return 0;
+  mnc[i].atm=0;
+  mnc[i].tx=o->x+(o->xv+o->vx)*6;mnc[i].ty=o->y-o->h/2+(o->yv+o->vy)*6;
+  if(abs(mnc[i].tx-mn[i].o.x)<abs(mnc[i].ty-mn[i].o.y+mn[i].o.h/2)) return 0;
   switch(mn[i].t) {
 	case MN_IMP: case MN_BARON: case MN_KNIGHT: case MN_CACO:
 	  setst(i,SHOOT);Z_sound(firsnd,128);break;
 	case MN_SKEL:
 	  setst(i,SHOOT);Z_sound(snd[MN_SKEL-1][2],128);break;
 	case MN_VILE:
-	  mn[i].tx=o->x;mn[i].ty=o->y;
+	  mnc[i].tx=o->x;mnc[i].ty=o->y;
 	  setst(i,SHOOT);Z_sound(fsnd,128);
 	  Z_sound(snd[MN_VILE-1][2],128);break;
 	case MN_SOUL:
 	  setst(i,ATTACK);Z_sound(snd[MN_SOUL-1][2],128);
-	  yd=mn[i].ty-mn[i].o.y+mn[i].o.h/2;xd=mn[i].tx-mn[i].o.x;
+	  yd=mnc[i].ty-mn[i].o.y+mn[i].o.h/2;xd=mnc[i].tx-mn[i].o.x;
 	  if(!(m=max(abs(xd),abs(yd)))) m=1;
 	  mn[i].o.xv=xd*16/m;mn[i].o.yv=yd*16/m;
 	  break;
-	case MN_MANCUB: if(mn[i].ammo==1) Z_sound(snd[MN_MANCUB-1][2],128);
+	case MN_MANCUB: if(mnc[i].ammo==1) Z_sound(snd[MN_MANCUB-1][2],128);
 	case MN_ZOMBY: case MN_SERG: case MN_BSP: case MN_ROBO:
 	case MN_CYBER: case MN_CGUN: case MN_SPIDER:
 	case MN_PAIN: case MN_MAN:
@@ -412,8 +436,8 @@ static int kick(int i,obj_t *o) {
 static int iscorpse(obj_t *o,int n) {
   int i;
 
-  if(!n) if(rand()&7) return -3;
-  for(i=0;i<MAXMN;++i) if(mn[i].t) if(mn[i].st==DEAD)
+  if(!n) if(RND_rand(RND_MONSTER)&7) return -3;
+  LV_EACH(i,mn_live,MAXMN) if(mn[i].st==DEAD)
     if(Z_overlap(o,&mn[i].o)) switch(mn[i].t) {
       case MN_SOUL: case MN_PAIN:
       case MN_CYBER: case MN_SPIDER:
@@ -426,7 +450,9 @@ static int iscorpse(obj_t *o,int n) {
   return -3;
 }
 
-static int Z_hitobj (int obj, int d, int own, int t) {
+static int Z_hitobj (int h, int d, int own, int t) {
+  int obj=MN_slot(h);
+
   hit_xv=hit_yv=0;
   if(obj==-1) return PL_hit(&pl1,d,own,t);
   else if(obj==-2 && _2pl) return PL_hit(&pl2,d,own,t);
@@ -437,26 +463,27 @@ static int Z_hitobj (int obj, int d, int own, int t) {
 
 void MN_act (void) {
   int i,st,sx,sy,t;
-  static obj_t o;
-  static int pt_x=0,pt_xs=1,pt_y=0,pt_ys=1;
+  static W_THREAD obj_t o;
 
   if(abs(pt_x+=pt_xs) > 123) pt_xs=-pt_xs;
   if(abs(pt_y+=pt_ys) > 50) pt_ys=-pt_ys;
   if(gsndt>0) if(--gsndt==0) {
-	Z_sound(gsnd[myrand(4)],128);
+	Z_sound(gsnd[RND_mod(RND_MONSTER,4)],128);
   }
-  for(i=0;i<MAXMN;++i) if((t=mn[i].t)!=0) {
+  LV_EACH(i,mn_live,MAXMN) {
+  t=mn[i].t;
   switch(t) {
 	case MN_FISH:
-	  if(!Z_inwater(mn[i].o.x,mn[i].o.y,mn[i].o.r,mn[i].o.h)) break;
+	  if(!Z_env(&world->mn_env[i],mn[i].o.x,mn[i].o.y,mn[i].o.r,mn[i].o.h)->water) break;
 	case MN_SOUL: case MN_PAIN: case MN_CACO:
 	  if(mn[i].st!=DIE && mn[i].st!=DEAD) --mn[i].o.yv;
 	  break;
-  }z_mon=1;st=Z_moveobj(&mn[i].o);z_mon=0;
-  BM_mark(&mn[i].o,BM_MONSTER);
+  }st=Z_movemon(&mn[i].o,&world->mn_env[i]);
+  BM_moved(i);
+  BM_place(i);
   if(st&Z_FALLOUT) {
     if(t==MN_ROBO) g_exit=1;
-    mn[i].t=0;--mnum;continue;
+    mn[i].t=0;LV_put(mn_live,i,0);--mnum;continue;
   }
   if(st&Z_HITWATER) Z_splash(&mn[i].o,mn[i].o.r+mn[i].o.h);
   SW_press(mn[i].o.x,mn[i].o.y,mn[i].o.r,mn[i].o.h,8,i);
@@ -464,17 +491,17 @@ void MN_act (void) {
     --mn[i].ftime;
     SMK_flame(mn[i].o.x,mn[i].o.y-mn[i].o.h/2,
       mn[i].o.xv+mn[i].o.vx,mn[i].o.yv+mn[i].o.vy,
-      mn[i].o.r/2,mn[i].o.h/2,rand()%(200*2+1)-200,-500,1,mn[i].fobj);
+      mn[i].o.r/2,mn[i].o.h/2,RND_rand(RND_MONSTER)%(200*2+1)-200,-500,1,MN_slot(mnc[i].fobj));
   }
   if(st&Z_INWATER) mn[i].ftime=0;
   if(mn[i].st==DEAD) continue;
-  if(st&Z_INWATER) if(!(rand()&31)) switch(t) {
+  if(st&Z_INWATER) if(!(RND_rand(RND_MONSTER)&31)) switch(t) {
     case MN_FISH:
-      if(rand()&3) break;
+      if(RND_rand(RND_MONSTER)&3) break;
     case MN_ROBO: case MN_BARREL:
     case MN_PL_DEAD: case MN_PL_MESS:
-      FX_bubble(mn[i].o.x+((rand()&1)*2-1)*myrand(mn[i].o.r+1),
-        mn[i].o.y-myrand(mn[i].o.h+1),0,0,1
+      FX_bubble(mn[i].o.x+((RND_rand(RND_MONSTER)&1)*2-1)*RND_mod(RND_MONSTER,mn[i].o.r+1),
+        mn[i].o.y-RND_mod(RND_MONSTER,mn[i].o.h+1),0,0,1
       );
       break;
     default:
@@ -483,55 +510,55 @@ void MN_act (void) {
 
   if(t==MN_BARREL) {
 
-    if(!mn[i].ap[++mn[i].ac]) {
-      mn[i].ac=0;if(mn[i].st==DIE || mn[i].st==DEAD) {mn[i].t=0;}
-    }else if(mn[i].st==DIE && mn[i].ac==2) Z_explode(mn[i].o.x,mn[i].o.y-8,30,mn[i].aim);
+    if(!mnc[i].ap[++mnc[i].ac]) {
+      mnc[i].ac=0;if(mn[i].st==DIE || mn[i].st==DEAD) {mn[i].t=0;LV_put(mn_live,i,0);}
+    }else if(mn[i].st==DIE && mnc[i].ac==2) Z_explode(mn[i].o.x,mn[i].o.y-8,30,MN_slot(mnc[i].aim));
     continue;
   }
   if(t==MN_SOUL) if(st&Z_HITAIR) Z_set_speed(&mn[i].o,16);
-  if(mn[i].ammo<0) ++mn[i].ammo;
+  if(mnc[i].ammo<0) ++mnc[i].ammo;
   if(mn[i].o.yv<0)
 	if(st&Z_INWATER) mn[i].o.yv=-4;
-  ++mn[i].atm;
+  ++mnc[i].atm;
   switch(mn[i].st) {
    case PAIN:
-	if(mn[i].pain>=mnsz[t].mp)
-	  {mn[i].pain=mnsz[t].mp;Z_sound(snd[t-1][1],128);}
-	if((mn[i].pain-=5)<=mnsz[t].minp)
-	  {setst(i,GO);mn[i].pain=0;mn[i].ammo=-9;}
+	if(mnc[i].pain>=mnsz[t].mp)
+	  {mnc[i].pain=mnsz[t].mp;Z_sound(snd[t-1][1],128);}
+	if((mnc[i].pain-=5)<=mnsz[t].minp)
+	  {setst(i,GO);mnc[i].pain=0;mnc[i].ammo=-9;}
 	break;
    case SLEEP:
-	if(++mn[i].s>=18) mn[i].s=0; else break;
+	if(++mnc[i].s>=18) mnc[i].s=0; else break;
 	if(Z_look(&mn[i].o,&pl1.o,mn[i].d))
-	  {setst(i,GO);mn[i].aim=-1;mn[i].atm=0;Z_sound(wakeupsnd(t),128);}
+	  {setst(i,GO);mnc[i].aim=-1;mnc[i].atm=0;Z_sound(wakeupsnd(t),128);}
 	if(_2pl) if(Z_look(&mn[i].o,&pl2.o,mn[i].d))
-	  {setst(i,GO);mn[i].aim=-2;mn[i].atm=0;Z_sound(wakeupsnd(t),128);}
+	  {setst(i,GO);mnc[i].aim=-2;mnc[i].atm=0;Z_sound(wakeupsnd(t),128);}
 	break;
    case WAIT:
-	if(--mn[i].s<0) setst(i,GO);
+	if(--mnc[i].s<0) setst(i,GO);
 	break;
    case GO:
-        if(st&Z_BLOCK) {mn[i].d^=1;setst(i,RUNOUT);mn[i].s=40;break;}
+        if(st&Z_BLOCK) {mn[i].d^=1;setst(i,RUNOUT);mnc[i].s=40;break;}
 	if(t==MN_VILE) if(iscorpse(&mn[i].o,0)>=0) {
 	  setst(i,ATTACK);mn[i].o.xv=0;break;
 	}
-	if(!Z_getobjpos(mn[i].aim,&o) || mn[i].atm>MAX_ATM)
+	if(!Z_getobjpos(mnc[i].aim,&o) || mnc[i].atm>MAX_ATM)
 	  if(!MN_findnewprey(i)) {
-		mn[i].aim=-3;
+		mnc[i].aim=-3;
 		o.x=mn[i].o.x+pt_x;o.y=mn[i].o.y+pt_y;
 		o.xv=o.vx=o.yv=o.vy=o.r=0;o.h=1;
-	  }else Z_getobjpos(mn[i].aim,&o);
+	  }else Z_getobjpos(mnc[i].aim,&o);
 	  if(Z_overlap(&mn[i].o,&o)) {
-	    mn[i].atm=0;
+	    mnc[i].atm=0;
 	    if(kick(i,&o)) break;
 	  }
 	  sx=o.x-mn[i].o.x;
 	  sy=o.y-o.h/2-mn[i].o.y+mn[i].o.h/2;
 	  if(!(st&Z_BLOCK)) if(abs(sx)<20)
-	    if(t!=MN_FISH) {setst(i,RUN);mn[i].s=15;mn[i].d=rand()&1;break;}
+	    if(t!=MN_FISH) {setst(i,RUN);mnc[i].s=15;mn[i].d=RND_rand(RND_MONSTER)&1;break;}
 	  if(st&Z_HITWALL) {
 		if(SW_press(mn[i].o.x,mn[i].o.y,mn[i].o.r,mn[i].o.h,2,i))
-		  {setst(i,WAIT);mn[i].s=4;break;}
+		  {setst(i,WAIT);mnc[i].s=4;break;}
 		switch(t) {
 		  case MN_CACO: case MN_SOUL: case MN_PAIN: case MN_FISH:
 			break;
@@ -549,49 +576,49 @@ void MN_act (void) {
 		  if(!(st&Z_INWATER)) {
 		    if(Z_canstand(mn[i].o.x,mn[i].o.y,mn[i].o.r)) {
 		      mn[i].o.yv=-6;
-		      mn[i].o.vx+=rand()%17-8;
-		    }setst(i,PAIN);mn[i].pain+=50;break;
+		      mn[i].o.vx+=RND_rand(RND_MONSTER)%17-8;
+		    }setst(i,PAIN);mnc[i].pain+=50;break;
 		  }
 		case MN_CACO: case MN_SOUL: case MN_PAIN:
 		  if(abs(sy)>4) mn[i].o.yv=(sy<0)?-4:4; else mn[i].o.yv=0;
 		  if(t==MN_FISH) if(mn[i].o.yv<0)
 		    if(!Z_inwater(mn[i].o.x,mn[i].o.y-8,mn[i].o.r,mn[i].o.h))
-		      {mn[i].o.yv=0;setst(i,RUN);mn[i].d=rand()&1;mn[i].s=20;}
+		      {mn[i].o.yv=0;setst(i,RUN);mn[i].d=RND_rand(RND_MONSTER)&1;mnc[i].s=20;}
 		  break;
 		default:
 		  if(sy<-20) if(Z_canstand(mn[i].o.x,mn[i].o.y,mn[i].o.r))
-			if(!(rand()&3)) mn[i].o.yv=-mnsz[t].jv;
+			if(!(RND_rand(RND_MONSTER)&3)) mn[i].o.yv=-mnsz[t].jv;
 	  }
-	if(++mn[i].s>=8) {
-	  mn[i].s=0;
-	  if(!(rand()&7)) Z_sound(snd[t-1][0],128);
+	if(++mnc[i].s>=8) {
+	  mnc[i].s=0;
+	  if(!(RND_rand(RND_MONSTER)&7)) Z_sound(snd[t-1][0],128);
 	}
 	mn[i].o.xv=((mn[i].d)?1:-1)*mnsz[t].rv;
 	if(st&Z_INWATER) mn[i].o.xv/=2;
 	  else if(t==MN_FISH) mn[i].o.xv=0;
 	break;
    case RUN:
-        if(st&Z_BLOCK) {setst(i,RUNOUT);mn[i].d^=1;mn[i].s=40;break;}
-	if(--mn[i].s<=0 || ((st&Z_HITWALL) && mn[i].o.yv+mn[i].o.vy==0)) {
-	  setst(i,GO);mn[i].s=0;if(st&(Z_HITWALL|Z_BLOCK)) mn[i].d^=1;
-	  if(!(rand()&7)) Z_sound(snd[t-1][0],128);
+        if(st&Z_BLOCK) {setst(i,RUNOUT);mn[i].d^=1;mnc[i].s=40;break;}
+	if(--mnc[i].s<=0 || ((st&Z_HITWALL) && mn[i].o.yv+mn[i].o.vy==0)) {
+	  setst(i,GO);mnc[i].s=0;if(st&(Z_HITWALL|Z_BLOCK)) mn[i].d^=1;
+	  if(!(RND_rand(RND_MONSTER)&7)) Z_sound(snd[t-1][0],128);
 	}mn[i].o.xv=((mn[i].d)?1:-1)*mnsz[t].rv;
 	if(st&Z_INWATER) mn[i].o.xv/=2;
 	  else if(t==MN_FISH) mn[i].o.xv=0;
 	break;
    case RUNOUT:
-        if(!(st&Z_BLOCK) && mn[i].s>0) mn[i].s=0;
-	if(--mn[i].s<=-18) {
-	  setst(i,GO);mn[i].s=0;if(st&(Z_HITWALL|Z_BLOCK)) mn[i].d^=1;
-	  if(!(rand()&7)) Z_sound(snd[t-1][0],128);
+        if(!(st&Z_BLOCK) && mnc[i].s>0) mnc[i].s=0;
+	if(--mnc[i].s<=-18) {
+	  setst(i,GO);mnc[i].s=0;if(st&(Z_HITWALL|Z_BLOCK)) mn[i].d^=1;
+	  if(!(RND_rand(RND_MONSTER)&7)) Z_sound(snd[t-1][0],128);
 	}mn[i].o.xv=((mn[i].d)?1:-1)*mnsz[t].rv;
 	if(st&Z_INWATER) mn[i].o.xv/=2;
 	  else if(t==MN_FISH) mn[i].o.xv=0;
 	break;
    case CLIMB:
 	if(mn[i].o.yv+mn[i].o.vy>=0 || !(st&Z_HITWALL)) {
-	  setst(i,GO);mn[i].s=0;
-	  if(st&(Z_HITWALL|Z_BLOCK)) {mn[i].d^=1;setst(i,RUN);mn[i].s=15;}
+	  setst(i,GO);mnc[i].s=0;
+	  if(st&(Z_HITWALL|Z_BLOCK)) {mn[i].d^=1;setst(i,RUN);mnc[i].s=15;}
 	}mn[i].o.xv=((mn[i].d)?1:-1)*mnsz[t].rv;
 	if(st&Z_INWATER) mn[i].o.xv/=2;
 	  else if(t==MN_FISH) mn[i].o.xv=0;
@@ -601,20 +628,20 @@ void MN_act (void) {
 	if(t==MN_SOUL) {if(st&(Z_HITWALL|Z_HITCEIL|Z_HITLAND)) setst(i,GO); break;}
 	if(t!=MN_FISH) mn[i].o.xv=Z_dec(mn[i].o.xv,1);
 	if(t==MN_VILE && mn[i].st==SHOOT) {
-          if(!Z_getobjpos(mn[i].aim,&o)) {setst(i,GO);break;}
+          if(!Z_getobjpos(mnc[i].aim,&o)) {setst(i,GO);break;}
           if(!Z_look(&mn[i].o,&o,mn[i].d)) {setst(i,GO);break;}
           if(Z_inwater(o.x,o.y,o.r,o.h)) {setst(i,GO);break;}
-          mn[i].tx=o.x;mn[i].ty=o.y;
-          Z_hitobj(mn[i].aim,2,i,HIT_SOME);
+          mnc[i].tx=o.x;mnc[i].ty=o.y;
+          Z_hitobj(mnc[i].aim,2,i,HIT_SOME);
 	}break;
   }
   if(mn[i].st==REVIVE) {
-    if(--mn[i].ac==0) setst(i,GO);
-  }else ++mn[i].ac;
-  if(!mn[i].ap[mn[i].ac]) switch(mn[i].st) {
+    if(--mnc[i].ac==0) setst(i,GO);
+  }else ++mnc[i].ac;
+  if(!mnc[i].ap[mnc[i].ac]) switch(mn[i].st) {
 	case ATTACK:
 	  switch(t) {
-		case MN_SOUL: mn[i].ac=0;
+		case MN_SOUL: mnc[i].ac=0;
 		case MN_IMP:
 		case MN_DEMON:
 		  if(Z_hit(&mn[i].o,15,i,HIT_SOME)) if(t==MN_SOUL) setst(i,GO);
@@ -639,50 +666,50 @@ void MN_act (void) {
 	case SHOOT:
 	  switch(t) {
 		case MN_IMP:
-		  WP_ball1(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_ball1(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_ZOMBY:
-		  WP_pistol(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_pistol(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_SERG:
-		  WP_shotgun(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_shotgun(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_MAN:
-		  WP_dshotgun(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
-		  mn[i].ammo=-36;break;
+		  WP_dshotgun(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
+		  mnc[i].ammo=-36;break;
 		case MN_CYBER:
-		  WP_rocket(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_rocket(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_SKEL:
-		  WP_revf(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i,mn[i].aim);
+		  WP_revf(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i,MN_slot(mnc[i].aim));
 		  break;
 		case MN_CGUN:
 		case MN_SPIDER:
-		  WP_mgun(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_mgun(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_BSP:
-		  WP_aplasma(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_aplasma(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_ROBO:
-		  WP_plasma(mn[i].o.x+(mn[i].d*2-1)*15,mn[i].o.y-30,mn[i].tx,mn[i].ty,i);
+		  WP_plasma(mn[i].o.x+(mn[i].d*2-1)*15,mn[i].o.y-30,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_MANCUB:
-		  WP_manfire(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_manfire(mn[i].o.x+(mn[i].d*2-1)*mn[i].o.r,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_BARON: case MN_KNIGHT:
-		  WP_ball7(mn[i].o.x,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_ball7(mn[i].o.x,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_CACO:
-		  WP_ball2(mn[i].o.x,mn[i].o.y-mn[i].o.h/2,mn[i].tx,mn[i].ty,i);
+		  WP_ball2(mn[i].o.x,mn[i].o.y-mn[i].o.h/2,mnc[i].tx,mnc[i].ty,i);
 		  break;
 		case MN_PAIN:
 		  if((sx=MN_spawn(mn[i].o.x,mn[i].o.y,mn[i].d,MN_SOUL))==-1) break;
-		  Z_getobjpos(mn[sx].aim=mn[i].aim,&o);mn[sx].atm=0;
+		  Z_getobjpos(mnc[sx].aim=mnc[i].aim,&o);mnc[sx].atm=0;
 		  shoot(sx,&o,1);
 		  break;
 	  }
 	  if(t==MN_CGUN || t==MN_SPIDER || t==MN_BSP || t==MN_MANCUB || t==MN_ROBO)
-	     if(!Z_getobjpos(mn[i].aim,&o)) MN_findnewprey(i);
+	     if(!Z_getobjpos(mnc[i].aim,&o)) MN_findnewprey(i);
 		else if(shoot(i,&o,0)) break;
 	  setst(i,GO);break;
 	case DIE:
@@ -696,23 +723,18 @@ void MN_act (void) {
 		if((sx=MN_spawn(mn[i].o.x,mn[i].o.y-10,1,MN_SOUL))==-1) break;
 		setst(sx,GO);
 	  }break;
-	default: mn[i].ac=0;
+	default: mnc[i].ac=0;
   }
   switch(mn[i].st) {
 	case GO: case RUN: case CLIMB: case RUNOUT:
 	  if(t==MN_CYBER || t==MN_SPIDER || t==MN_BSP) {
-	    if(mn[i].ac==0 || mn[i].ac==6) Z_sound(snd[t-1][2],128);
+	    if(mnc[i].ac==0 || mnc[i].ac==6) Z_sound(snd[t-1][2],128);
 	  }else if(t==MN_ROBO)
-	    if(mn[i].ac==0 || mn[i].ac==12) Z_sound(snd[t-1][2],128);
+	    if(mnc[i].ac==0 || mnc[i].ac==12) Z_sound(snd[t-1][2],128);
   }
   }
 }
 
-void MN_mark (void) {
-  int i;
-  for(i=0;i<MAXMN;++i) if(mn[i].t!=0) BM_mark(&mn[i].o,BM_MONSTER);
-}
-
 int MN_hit(int n,int d,int o,int t) {
   int i;
 
@@ -732,22 +754,22 @@ int MN_hit(int n,int d,int o,int t) {
 		return 0;
 	}
   }
-  if(t==HIT_FLAME) if(mn[n].ftime && mn[n].fobj==o) {if(g_time&31) return 1;}
-    else {mn[n].ftime=255;mn[n].fobj=o;}
+  if(t==HIT_FLAME) if(mn[n].ftime && mnc[n].fobj==MN_ref(o)) {if(g_time&31) return 1;}
+    else {mn[n].ftime=255;mnc[n].fobj=MN_ref(o);}
   if(t==HIT_ELECTRO) if(mn[n].t==MN_FISH)
-    {setst(n,RUN);mn[n].s=20;mn[n].d=rand()&1;return 1;}
-  if(t==HIT_TRAP) mn[n].life=-100;
+    {setst(n,RUN);mnc[n].s=20;mn[n].d=RND_rand(RND_MONSTER)&1;return 1;}
+  if(t==HIT_TRAP) mnc[n].life=-100;
   if(mn[n].t==MN_ROBO) d=0;
-  if((mn[n].life-=d)<=0) --mnum;
-  if(!mn[n].pain) mn[n].pain=3;
-  mn[n].pain+=d;
+  if((mnc[n].life-=d)<=0) --mnum;
+  if(!mnc[n].pain) mnc[n].pain=3;
+  mnc[n].pain+=d;
   if(mn[n].st!=PAIN) {
-	if(mn[n].pain>=mnsz[mn[n].t].minp) setst(n,PAIN);
+	if(mnc[n].pain>=mnsz[mn[n].t].minp) setst(n,PAIN);
   }
   if(mn[n].t!=MN_BARREL)
     DOT_blood(mn[n].o.x,mn[n].o.y-mn[n].o.h/2,hit_xv,hit_yv,d*2);
-  mn[n].aim=o;mn[n].atm=0;
-  if(mn[n].life<=0) {
+  mnc[n].aim=MN_ref(o);mnc[n].atm=0;
+  if(mnc[n].life<=0) {
 	if(mn[n].t!=MN_BARREL)
 	  if(o==-1) ++pl1.kills;
 	  else if(o==-2) ++pl2.kills;
@@ -760,11 +782,12 @@ int MN_hit(int n,int d,int o,int t) {
 	  default: i=0;
 	}if(i) IT_spawn(mn[n].o.x,mn[n].o.y,i);
 	mn[n].o.xv=0;mn[n].o.h=6;
-	if(mn[n].life<=-mnsz[mn[n].t].sp)
+	BM_place(n);
+	if(mnc[n].life<=-mnsz[mn[n].t].sp)
 	  switch(mn[n].t) {
 		case MN_IMP: case MN_ZOMBY: case MN_SERG: case MN_CGUN:
 		case MN_MAN:
-		  mn[n].ap=slopanim[mn[n].t-1];
+		  mnc[n].ap=slopanim[mn[n].t-1];
 		  Z_sound(slopsnd,128);
 		  break;
 		case MN_BSP: if(g_map==9) break;
@@ -772,8 +795,8 @@ int MN_hit(int n,int d,int o,int t) {
 		  Z_sound(dthsnd(mn[n].t),128);
 	  }
 	else if(mn[n].t!=MN_BSP || g_map!=9) Z_sound(dthsnd(mn[n].t),128);
-	mn[n].life=0;
-  }else if(mn[n].st==SLEEP) {setst(n,GO);mn[n].pain=mnsz[mn[n].t].mp;}
+	mnc[n].life=0;
+  }else if(mn[n].st==SLEEP) {setst(n,GO);mnc[n].pain=mnsz[mn[n].t].mp;}
   return 1;
 }
 
@@ -781,13 +804,15 @@ int MN_hit(int n,int d,int o,int t) {
 
 int Z_gunhit (int x, int y, int o, int xv, int yv) {
   int i;
+  uint64_t near[BM_MNW];
 
   if(o!=-1) if(hit(pl1.o,x,y)) if(PL_hit(&pl1,3,o,HIT_SOME))
     {pl1.o.vx+=xv;pl1.o.vy+=yv;return -1;}
   if(_2pl && o!=-2) if(hit(pl2.o,x,y)) if(PL_hit(&pl2,3,o,HIT_SOME))
     {pl2.o.vx+=xv;pl2.o.vy+=yv;return -2;}
 
-  for(i=0;i<MAXMN;++i) if(mn[i].t && o!=i)
+  BM_near(x,y,x,y,near);
+  while((i=BM_pop(near))>=0) if(mn[i].t && o!=i)
     if(hit(mn[i].o,x,y)) if(MN_hit(i,3,o,HIT_SOME))
       {mn[i].o.vx+=xv;mn[i].o.vy+=yv;return 1;}
   return 0;
@@ -800,6 +825,7 @@ static void goodsnd(void) {
 
 int Z_hit (obj_t *o, int d, int own, int t) {
   int i;
+  uint64_t near[BM_MNW];
 
   hit_xv=o->xv+o->vx;
   hit_yv=o->yv+o->vy;
@@ -816,7 +842,8 @@ int Z_hit (obj_t *o, int d, int own, int t) {
 	return -2;
   }
 
-  for(i=0;i<MAXMN;++i) if(mn[i].t)
+  BM_near(o->x-o->r,o->y-o->h,o->x+o->r,o->y,near);
+  while((i=BM_pop(near))>=0) if(mn[i].t)
     if(Z_overlap(o,&mn[i].o)) if(MN_hit(i,d,own,t)) {
 	  mn[i].o.vx+=(o->xv+o->vx)*((t==HIT_BFG)?8:1)/4;
 	  mn[i].o.vy+=(o->yv+o->vy)*((t==HIT_BFG)?8:1)/4;
@@ -827,7 +854,7 @@ int Z_hit (obj_t *o, int d, int own, int t) {
 
 void MN_killedp (void) {
   int i;
-  for(i=0;i<MAXMN;++i) if(mn[i].t==MN_MAN)
+  LV_EACH(i,mn_live,MAXMN) if(mn[i].t==MN_MAN)
     if(mn[i].st!=DEAD && mn[i].st!=DIE && mn[i].st!=SLEEP)
       Z_sound(trupsnd,128);
 }
@@ -835,6 +862,7 @@ void MN_killedp (void) {
 void Z_explode (int x,int y,int rad,int own) {
   long r;
   int dx,dy,m,i;
+  uint64_t near[BM_MNW];
 
   if(x<-100 || x>FLDW*CELW+100) return;
   if(y<-100 || y>FLDH*CELH+100) return;
@@ -855,7 +883,8 @@ void Z_explode (int x,int y,int rad,int own) {
       PL_hit(&pl2,100*(rad-m)/rad,own,HIT_ROCKET);
     }
   }
-  for(i=0;i<MAXMN;++i) if(mn[i].t) {
+  BM_near(x-rad,y-rad,x+rad,y+rad,near);
+  while((i=BM_pop(near))>=0) if(mn[i].t) {
     dx=mn[i].o.x-x;dy=mn[i].o.y-mn[i].o.h/2-y;
     if((long)dx*dx+(long)dy*dy<r) {
       if(!(m=max(abs(dx),abs(dy)))) m=1;
@@ -868,6 +897,7 @@ void Z_explode (int x,int y,int rad,int own) {
 
 void Z_bfg9000 (int x,int y,int own) {
   int dx,dy,i;
+  uint64_t near[BM_MNW];
 
   hit_xv=hit_yv=0;
   if(x<-100 || x>FLDW*CELW+100) return;
@@ -886,7 +916,8 @@ void Z_bfg9000 (int x,int y,int own) {
 	WP_bfghit(pl2.o.x,pl2.o.y-pl2.o.h/2,own);
     }
   }
-  for(i=0;i<MAXMN;++i) if(mn[i].t && own!=i) {
+  BM_near(x-127,y-127,x+127,y+127,near); // dx*dx < 16000 means abs(dx) < 127
+  while((i=BM_pop(near))>=0) if(mn[i].t && own!=i) {
     dx=mn[i].o.x-x;dy=mn[i].o.y-mn[i].o.h/2-y;
     if((long)dx*dx+(long)dy*dy<16000)
      if(Z_cansee(x,y,mn[i].o.x,mn[i].o.y-mn[i].o.h/2)) {
@@ -897,7 +928,8 @@ void Z_bfg9000 (int x,int y,int own) {
 }
 
 int Z_chktrap (int t, int d, int o, int ht) {
-  int i,s;
+  int i,s,x0,y0,x1,y1;
+  uint64_t near[BM_MNW];
 
   hit_xv=hit_yv=0;
   s=0;
@@ -909,7 +941,9 @@ int Z_chktrap (int t, int d, int o, int ht) {
 	s=1;
 	if(t) PL_hit(&pl2,d,o,ht);
   }
-  for(i=0;i<MAXMN;++i) if(mn[i].t && mn[i].st!=DEAD)
+  if(!Z_traps(&x0,&y0,&x1,&y1)) return s;
+  BM_near(x0,y0,x1,y1,near);
+  while((i=BM_pop(near))>=0) if(mn[i].t && mn[i].st!=DEAD)
     if(Z_istrapped(mn[i].o.x,mn[i].o.y,mn[i].o.r,mn[i].o.h)) {
       s=1;
 	  if(t) MN_hit(i,d,o,ht);
@@ -925,13 +959,16 @@ void Z_teleobj (int o, int x, int y) {
   else if(o>=0 && o<MAXMN) p=&mn[o].o;
   else return;
   FX_tfog(p->x,p->y);FX_tfog(p->x=x,p->y=y);
+  if(o>=0) BM_place(o);
   Z_sound(telesnd,128);
 }
 
 void MN_warning (int l,int t,int r,int b) {
   int i;
+  uint64_t near[BM_MNW];
 
-  for(i=0;i<MAXMN;++i) if(mn[i].t && mn[i].t!=MN_CACO && mn[i].t!=MN_SOUL
+  BM_near(l,t,r,b,near);
+  while((i=BM_pop(near))>=0) if(mn[i].t && mn[i].t!=MN_CACO && mn[i].t!=MN_SOUL
       && mn[i].t!=MN_PAIN && mn[i].t!=MN_FISH)
     if(mn[i].st!=DIE && mn[i].st!=DEAD && mn[i].st!=SLEEP)
       if(mn[i].o.x+mn[i].o.r>=l && mn[i].o.x-mn[i].o.r<=r
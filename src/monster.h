@@ -21,7 +21,7 @@
 #include "glob.h"
 #include "view.h" // obj_t
 
-#define MAXMN 200
+#define MAXMN (200 * POOL_SCALE)
 
 enum {
   MN_NONE, MN_DEMON, MN_IMP, MN_ZOMBY, MN_SERG, MN_CYBER, MN_CGUN,
@@ -34,20 +34,34 @@ enum {
 
 #define MN_TN (MN__LAST-MN_DEMON)
 
+/* what pool scans read, the rest is in mn_cold_t */
 typedef struct {
   obj_t o;
   byte t, d, st, ftime;
-  int fobj;
+} mn_t;
+
+/* AI and animation, touched by MN_act, MN_hit and the renderers only */
+typedef struct {
+  int fobj; // handle
   int s;
   char *ap;
-  int aim, life, pain, ac, tx, ty, ammo;
+  int aim; // handle
+  int life, pain, ac, tx, ty, ammo;
   short atm;
-} mn_t;
+} mn_cold_t;
+
+/*
+ * What is remembered across ticks (aims, owners of shots and flames) keeps
+ * monsters by handle: slot in the low MN_SLOTBITS, the count of spawns into
+ * that slot above. Once the slot is taken by another monster the handle
+ * resolves to -3, nobody. Players -1 and -2 and nobody are their own handles.
+ */
+#define MN_SLOTBITS 16
+#if MAXMN > (1 << MN_SLOTBITS)
+#  error "MAXMN does not fit in a monster handle"
+#endif
 
 extern byte nomon;
-extern int hit_xv, hit_yv;
-extern mn_t mn[MAXMN];
-extern int mnum, gsndt;
 
 void setst (int i, int st);
 
@@ -55,9 +69,10 @@ void MN_alloc (void);
 void MN_init (void);
 int MN_spawn (int x, int y, byte d, int t);
 int MN_spawn_deadpl (obj_t *o, byte c, int t);
-int Z_getobjpos (int i, obj_t *o);
+int MN_ref (int i);
+int MN_slot (int h);
+int Z_getobjpos (int h, obj_t *o);
 void MN_act (void);
-void MN_mark (void);
 int MN_hit (int n, int d, int o, int t);
 int Z_gunhit (int x, int y, int o, int xv, int yv);
 int Z_hit (obj_t *o, int d, int own, int t);
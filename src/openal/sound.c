@@ -423,3 +423,16 @@ void S_wait (void) {
     }
   }
 }
+
+int S_playing (void) {
+  int i, n = 0;
+  ALint state;
+  if (context != NULL) {
+    for (i = 0; i < MAX_CHANNELS; i++) {
+      state = AL_STOPPED;
+      alGetSourcei(sources[i], AL_SOURCE_STATE, &state);
+      n += state == AL_PLAYING;
+    }
+  }
+  return n;
+}
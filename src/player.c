@@ -30,6 +30,8 @@
 #include "misc.h"
 #include "game.h"
 #include "input.h"
+#include "rnd.h"
+#include "world.h"
 
 #define PL_RAD 8
 #define PL_HT 26
@@ -39,21 +41,18 @@
 
 #define PL_AQUA_AIR 1091
 
-byte p_immortal;
-byte p_fly;
-
-int PL_JUMP=10;
-int PL_RUN=8;
-
 static int wp_it[11]={0,I_CSAW,0,I_SGUN,I_SGUN2,I_MGUN,I_LAUN,I_PLAS,I_BFG,I_GUN2,0};
 
 enum{STAND,GO,DIE,SLOP,DEAD,MESS,OUT,FALL};
 
 typedef void fire_f(int,int,int,int,int);
 
-player_t pl1;
-player_t pl2;
-static int aitime;
+plkeys_t pl1_keys;
+plkeys_t pl2_keys;
+
+#define aitime (world->pl_aitime)
+#define PK(p) ((p) == &pl1 ? &pl1_keys : &pl2_keys)
+#define PL_ENV(p) ((p) == &pl1 ? &world->pl_env[0] : &world->pl_env[1])
 static void *aisnd[3];
 static void *pdsnd[5];
 
@@ -81,22 +80,22 @@ static void fire(player_t *p) {
   if(p->cwpn) return;
   if(p->wpn==8) {
     if(!p->fire)
-      if(I_pressed(p->kf) && p->cell>=40)
+      if(I_pressed(PK(p)->kf) && p->cell>=40)
 	{Z_sound(snd[5],128);p->fire=21;p->cell-=40;p->drawst|=PL_DRAWWPN;return;}
       else return;
     if(p->fire==1) p->cwpn=12;
     else return;
   }else if(p->wpn==1) {
     if(!p->csnd) {
-      if(!I_pressed(p->kf)) {Z_sound(snd[7],128);p->csnd=13;return;}
+      if(!I_pressed(PK(p)->kf)) {Z_sound(snd[7],128);p->csnd=13;return;}
     }
-    if(I_pressed(p->kf) && !p->fire) {
+    if(I_pressed(PK(p)->kf) && !p->fire) {
       p->fire=2;
 	  WP_chainsaw(p->o.x+((p->d)?4:-4),p->o.y,(g_dm)?9:3,p->id);
       if(!p->csnd) {Z_sound(snd[8],128);p->csnd=29;}
     }return;
   }else if(p->fire) return;
-  if(I_pressed(p->kf) || p->wpn==8) {
+  if(I_pressed(PK(p)->kf) || p->wpn==8) {
     switch(p->wpn) {
       case 2: case 5:
 	if(!p->ammo) return;
@@ -131,10 +130,10 @@ static void fire(player_t *p) {
 static void chgwpn(player_t *p) {
   if(p->cwpn) return;
   if(p->fire && p->wpn!=1) return;
-  if(I_pressed(p->kwl)) {
+  if(I_pressed(PK(p)->kwl)) {
 	do{ if(--p->wpn<0) p->wpn=10; }while(!(p->wpns&(1<<p->wpn)));
 	p->cwpn=3;
-  }else if(I_pressed(p->kwr)) {
+  }else if(I_pressed(PK(p)->kwr)) {
 	do{ if(++p->wpn>10) p->wpn=0; }while(!(p->wpns&(1<<p->wpn)));
 	p->cwpn=3;
   }
@@ -145,7 +144,7 @@ static void chgwpn(player_t *p) {
 }
 
 static void jump(player_t *p,int st) {
-  if(Z_canbreathe(p->o.x,p->o.y,p->o.r,p->o.h)) {
+  if(Z_env(PL_ENV(p),p->o.x,p->o.y,p->o.r,p->o.h)->air) {
 	if(p->air<PL_AIR) {p->air=PL_AIR;p->drawst|=PL_DRAWAIR;}
   }else {
 	if(--p->air < -9) {
@@ -156,7 +155,7 @@ static void jump(player_t *p,int st) {
 	}
 	p->drawst|=PL_DRAWAIR;
   }
-  if(I_pressed(p->kj)) {
+  if(I_pressed(PK(p)->kj)) {
     if(p_fly) {
       p->o.yv=-PL_FLYUP;
     }else{
@@ -283,7 +282,7 @@ void PL_damage (player_t *p) {
   p->drawst|=PL_DRAWLIFE|PL_DRAWARMOR;
   if((p->armor-=p->hit-i)<0) {p->life+=p->armor;p->armor=0;}
   if((p->life-=i)<=0) {
-    if(p->life>-30) {p->st=DIE;p->s=0;Z_sound(pdsnd[rand()%5],128);}
+    if(p->life>-30) {p->st=DIE;p->s=0;Z_sound(pdsnd[RND_rand(RND_PLAYER)%5],128);}
 	else {p->st=SLOP;p->s=0;Z_sound(snd[3],128);}
 	if(p->amul>1) IT_spawn(p->o.x,p->o.y,I_BPACK);
 	if(!g_dm) {
@@ -445,9 +444,9 @@ void PL_act (player_t *p) {
   if(--aitime<0) aitime=0;
   SW_press(p->o.x,p->o.y,p->o.r,p->o.h,4|p->keys,p->id);
   if(!p->suit) if((g_time&15)==0)
-    PL_hit(p,Z_getacid(p->o.x,p->o.y,p->o.r,p->o.h),-3,HIT_SOME);
+    PL_hit(p,Z_env(PL_ENV(p),p->o.x,p->o.y,p->o.r,p->o.h)->acid,-3,HIT_SOME);
   if(p->st!=FALL && p->st!=OUT) {
-	if(((st=Z_moveobj(&p->o))&Z_FALLOUT) && p->o.y>=FLDH*CELH+50) {
+	if(((st=Z_moveobj(&p->o,PL_ENV(p)))&Z_FALLOUT) && p->o.y>=FLDH*CELH+50) {
 	  switch(p->st) {
 		case DEAD: case MESS: case DIE: case SLOP:
 		  p->s=5;break;
@@ -459,14 +458,14 @@ void PL_act (player_t *p) {
   }else st=0;
   if(st&Z_HITWATER) Z_splash(&p->o,PL_RAD+PL_HT);
   if(p->f&PLF_FIRE) if(p->fire!=2) p->f-=PLF_FIRE;
-  if(I_pressed(p->ku)) {p->f|=PLF_UP;p->looky-=5;}
+  if(I_pressed(PK(p)->ku)) {p->f|=PLF_UP;p->looky-=5;}
   else{
     p->f&=0xFFFF-PLF_UP;
-	if(I_pressed(p->kd))
+	if(I_pressed(PK(p)->kd))
 	  {p->f|=PLF_DOWN;p->looky+=5;}
 	else {p->f&=0xFFFF-PLF_DOWN;p->looky=Z_dec(p->looky,5);}
   }
-  if(I_pressed(p->kp)) SW_press(p->o.x,p->o.y,p->o.r,p->o.h,1|p->keys,p->id);
+  if(I_pressed(PK(p)->kp)) SW_press(p->o.x,p->o.y,p->o.r,p->o.h,1|p->keys,p->id);
   if(p->fire) --p->fire;
   if(p->cwpn) --p->cwpn;
   if(p->csnd) --p->csnd;
@@ -488,15 +487,15 @@ void PL_act (player_t *p) {
 	  if(p_fly)
 	    SMK_gas(p->o.x,p->o.y-2,2,3,p->o.xv+p->o.vx,p->o.yv+p->o.vy,128);
 	  if((p->s+=abs(p->o.xv)/2) >= 24) p->s%=24;
-	  if(!I_pressed(p->kl) && !I_pressed(p->kr)) {
+	  if(!I_pressed(PK(p)->kl) && !I_pressed(PK(p)->kr)) {
 		if(p->o.xv) p->o.xv=Z_dec(p->o.xv,1);
 		else p->st=STAND;
 		break;
 	  }
-	  if(p->o.xv<PL_RUN && I_pressed(p->kr)) {p->o.xv+=PL_RUN>>3;p->d=1;}
+	  if(p->o.xv<PL_RUN && I_pressed(PK(p)->kr)) {p->o.xv+=PL_RUN>>3;p->d=1;}
 	    else if(PL_RUN>8)
 	      SMK_gas(p->o.x,p->o.y-2,2,3,p->o.xv+p->o.vx,p->o.yv+p->o.vy,32);
-	  if(p->o.xv>-PL_RUN && I_pressed(p->kl)) {p->o.xv-=PL_RUN>>3;p->d=0;}
+	  if(p->o.xv>-PL_RUN && I_pressed(PK(p)->kl)) {p->o.xv-=PL_RUN>>3;p->d=0;}
 	    else if(PL_RUN>8)
 	      SMK_gas(p->o.x,p->o.y-2,2,3,p->o.xv+p->o.vx,p->o.yv+p->o.vy,32);
 	  break;
@@ -504,15 +503,15 @@ void PL_act (player_t *p) {
 	  chgwpn(p);fire(p);jump(p,st);
 	  if(p_fly)
 	    SMK_gas(p->o.x,p->o.y-2,2,3,p->o.xv+p->o.vx,p->o.yv+p->o.vy,128);
-	  if(I_pressed(p->kl)) {p->st=GO;p->s=0;p->d=0;}
-      else if(I_pressed(p->kr)) {p->st=GO;p->s=0;p->d=1;}
+	  if(I_pressed(PK(p)->kl)) {p->st=GO;p->s=0;p->d=0;}
+      else if(I_pressed(PK(p)->kr)) {p->st=GO;p->s=0;p->d=1;}
       break;
     case DEAD:
     case MESS:
     case OUT:
 	  p->o.xv=Z_dec(p->o.xv,1);
-	  if(I_pressed(p->ku) || I_pressed(p->kd) || I_pressed(p->kl) || I_pressed(p->kr) ||
-	     I_pressed(p->kf) || I_pressed(p->kj) || I_pressed(p->kp) || I_pressed(p->kwl) || I_pressed(p->kwr)) {
+	  if(I_pressed(PK(p)->ku) || I_pressed(PK(p)->kd) || I_pressed(PK(p)->kl) || I_pressed(PK(p)->kr) ||
+	     I_pressed(PK(p)->kf) || I_pressed(PK(p)->kj) || I_pressed(PK(p)->kp) || I_pressed(PK(p)->kwl) || I_pressed(PK(p)->kwr)) {
 		if(p->st!=OUT) MN_spawn_deadpl(&p->o,p->color,(p->st==MESS)?1:0);
 		PL_restore(p);
 		if(g_dm) {G_respawn_player(p);break;}
@@ -542,7 +541,7 @@ static void chk_bfg(player_t *p,int x,int y) {
   }
   dx=p->o.x-x;dy=p->o.y-p->o.h/2-y;
   if(dx*dx+dy*dy<=1600) {
-    aitime=Z_sound(aisnd[rand()%3],128)*4;
+    aitime=Z_sound(aisnd[RND_rand(RND_PLAYER)%3],128)*4;
   }
 }
 
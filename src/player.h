@@ -67,16 +67,15 @@ typedef struct {
   int id;
   byte keys;
   char lives;
-  int ku, kd, kl, kr, kf, kj, kwl, kwr, kp;
 } player_t;
 
-extern byte p_immortal;
-extern byte p_fly;
-extern int PL_JUMP;
-extern int PL_RUN;
+/* key bindings belong to the machine, not to a world */
+typedef struct {
+  int ku, kd, kl, kr, kf, kj, kwl, kwr, kp;
+} plkeys_t;
 
-extern player_t pl1;
-extern player_t pl2;
+extern plkeys_t pl1_keys;
+extern plkeys_t pl2_keys;
 
 extern byte plr_goanim[];
 extern byte plr_dieanim[];
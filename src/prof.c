@@ -0,0 +1,161 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "prof.h"
+
+#ifdef PROFILER
+
+#include <stdio.h>
+#include <stdlib.h> // qsort atexit
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include "error.h"
+#include "view.h" // GS_GAME
+#include "world.h" // g_st
+
+#define PF_FILE "profile.csv"
+
+byte pf_show;
+
+static const char *names[PF__LAST] = {
+  "CODE", "ITEMS", "SWITCH", "PLAYER", "MONSTER", "BMAP",
+  "WEAPON", "MOVE", "DOTS", "SMOKE", "FX", "DAMAGE", "TICK"
+};
+
+/* per thread, only the main one is dumped at exit */
+static W_THREAD unsigned long long start[PF__LAST]; /* ns */
+static W_THREAD dword ring[PF_RING][PF__LAST]; /* ns, stage may run several times per tick */
+static W_THREAD int pos;
+static W_THREAD int num;
+
+static unsigned long long nanotime (void) {
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  return clock() * (1000000000ULL / CLOCKS_PER_SEC);
+#endif
+}
+
+static void PF_dump (void) {
+  int i, j, k;
+  FILE *f = fopen(PF_FILE, "w");
+  if (f == NULL) {
+    logo("PF_dump: can't write %s\n", PF_FILE);
+    return;
+  }
+  fprintf(f, "tick");
+  for (j = 0; j < PF__LAST; j++) {
+    fprintf(f, ",%s", names[j]);
+  }
+  fprintf(f, "\n");
+  for (i = 0; i < num; i++) {
+    k = (pos - num + i + PF_RING) % PF_RING;
+    fprintf(f, "%i", i);
+    for (j = 0; j < PF__LAST; j++) {
+      fprintf(f, ",%u", ring[k][j]);
+    }
+    fprintf(f, "\n");
+  }
+  fclose(f);
+}
+
+void PF_init (void) {
+  atexit(PF_dump);
+}
+
+void PF_begin (int s) {
+  assert(s >= 0 && s < PF__LAST);
+  if (s == PF_TICK) {
+    memset(ring[pos], 0, sizeof(ring[pos]));
+  }
+  start[s] = nanotime();
+}
+
+void PF_end (int s) {
+  assert(s >= 0 && s < PF__LAST);
+  ring[pos][s] += nanotime() - start[s];
+  if (s == PF_TICK) {
+    pos = (pos + 1) % PF_RING;
+    num = min(num + 1, PF_RING);
+  }
+}
+
+static int cmp_dword (const void *a, const void *b) {
+  dword x = *(const dword *)a;
+  dword y = *(const dword *)b;
+  return x < y ? -1 : x > y;
+}
+
+void PF_stat (int s, pf_stat_t *st) {
+  int i;
+  unsigned long long sum;
+  dword buf[PF_RING];
+  assert(s >= 0 && s < PF__LAST);
+  assert(st != NULL);
+  if (num > 0) {
+    sum = 0;
+    for (i = 0; i < num; i++) {
+      buf[i] = ring[(pos - num + i + PF_RING) % PF_RING][s];
+      sum += buf[i];
+    }
+    qsort(buf, num, sizeof(buf[0]), cmp_dword);
+    st->min = buf[0];
+    st->avg = sum / num;
+    st->p99 = buf[num * 99 / 100];
+  } else {
+    st->min = st->avg = st->p99 = 0;
+  }
+}
+
+dword PF_last (int s) {
+  assert(s >= 0 && s < PF__LAST);
+  return num > 0 ? ring[(pos - 1 + PF_RING) % PF_RING][s] : 0;
+}
+
+const char *PF_name (int s) {
+  assert(s >= 0 && s < PF__LAST);
+  return names[s];
+}
+
+static void PF_drawtime (void (*text)(int x, int y, const char *s), int x, int y, dword ns) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u", ns / 1000, ns / 100 % 10);
+  text(x, y, buf);
+}
+
+void PF_draw (void (*text)(int x, int y, const char *s)) {
+  int i, y;
+  pf_stat_t st;
+  assert(text != NULL);
+  if (pf_show && g_st == GS_GAME) {
+    text(4, 4, "US");
+    text(54, 4, "MIN");
+    text(94, 4, "AVG");
+    text(134, 4, "P99");
+    for (i = 0; i < PF__LAST; i++) {
+      PF_stat(i, &st);
+      y = 14 + i * 8;
+      text(4, y, names[i]);
+      PF_drawtime(text, 54, y, st.min);
+      PF_drawtime(text, 94, y, st.avg);
+      PF_drawtime(text, 134, y, st.p99);
+    }
+  }
+}
+
+#endif /* PROFILER */
@@ -0,0 +1,54 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROF_H_INCLUDED
+#define PROF_H_INCLUDED
+
+#include "glob.h"
+
+/* G_act stages */
+enum {
+  PF_CODE, PF_ITEMS, PF_SWITCH, PF_PLAYER, PF_MONSTER, PF_BMAP,
+  PF_WEAPON, PF_MOVE, PF_DOTS, PF_SMOKE, PF_FX, PF_DAMAGE, PF_TICK,
+  PF__LAST
+};
+
+#define PF_RING 256 // ticks kept for statistics
+
+typedef struct pf_stat_t {
+  dword min, avg, p99; // ns
+} pf_stat_t;
+
+#ifdef PROFILER
+
+extern byte pf_show;
+
+void PF_init (void);
+void PF_begin (int s);
+void PF_end (int s);
+void PF_stat (int s, pf_stat_t *st);
+dword PF_last (int s); // ns spent in the last finished tick
+const char *PF_name (int s);
+void PF_draw (void (*text)(int x, int y, const char *s)); // overlay, renderer draws the text
+
+#else
+
+#  define PF_init()
+#  define PF_begin(s)
+#  define PF_end(s)
+
+#endif /* PROFILER */
+
+#endif /* PROF_H_INCLUDED */
@@ -24,7 +24,7 @@ const cfg_t *R_conf (void);
 const menu_t *R_menu (void);
 
 void R_init (void);
-void R_draw (void);
+void R_draw (int alpha); // 0..W_ALPHA, time passed since last tick
 void R_done (void);
 
 void R_set_videomode (int w, int h, int fullscreen);
@@ -39,4 +39,6 @@ void R_load (char s[8]);
 void R_end_load (void);
 void R_loadsky (int sky);
 
+int R_atlas_pages (void); // texture pages in use, 0 if renderer has no atlas
+
 #endif /* RENDER_H_INCLUDED */
@@ -0,0 +1,54 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rnd.h"
+#include <assert.h>
+#include "world.h"
+
+/* PCG32 (XSH-RR), see pcg-random.org */
+
+static uint32_t next (rnd_t *r) {
+  uint64_t old = r->s;
+  uint32_t x, rot;
+  r->s = old * 6364136223846793005ULL + r->inc;
+  x = ((old >> 18) ^ old) >> 27;
+  rot = old >> 59;
+  return (x >> rot) | (x << (-rot & 31));
+}
+
+static void seed (rnd_t *r, unsigned v, int stream) {
+  r->s = 0;
+  r->inc = (uint64_t)stream << 1 | 1;
+  next(r);
+  r->s += v;
+  next(r);
+}
+
+void RND_start (unsigned s) {
+  int i;
+  for (i = 0; i < RND__LAST; i++) {
+    seed(&rnd[i], s, i);
+  }
+}
+
+/* same range as rand() with 31-bit RAND_MAX */
+int RND_rand (int s) {
+  assert(s >= 0 && s < RND__LAST);
+  return next(&rnd[s]) >> 1;
+}
+
+int RND_mod (int s, int n) {
+  return RND_rand(s) % n;
+}
@@ -0,0 +1,36 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RND_H_INCLUDED
+#define RND_H_INCLUDED
+
+#include <stdint.h> // uint64_t
+
+/* independent random streams, one per subsystem */
+enum {
+  RND_INIT, RND_GAME, RND_PLAYER, RND_MONSTER, RND_ITEMS, RND_WEAPON,
+  RND_DOTS, RND_SMOKE, RND_FX,
+  RND__LAST
+};
+
+typedef struct rnd_t {
+  uint64_t s, inc;
+} rnd_t;
+
+void RND_start (unsigned seed);
+int RND_rand (int s);
+int RND_mod (int s, int n);
+
+#endif /* RND_H_INCLUDED */
@@ -35,45 +35,64 @@
 
 #include "common/streams.h"
 #include "common/files.h"
+#include "world.h"
+#include "live.h"
+#include "error.h"
+
+/* version 3 is the stock format, a POOL_SCALE build adds its scale after it */
+#if POOL_SCALE > 1
+#  define SAVE_VERSION 4
+#else
+#  define SAVE_VERSION 3
+#endif
+
+static int SAVE_count (Stream *h, int max, const char *what) {
+  int n = stream_read32(h);
+  if (n < 0 || n > max) {
+    ERR_fatal("SAVE_load: %d %s, pool holds %d", n, what, max);
+  }
+  return n;
+}
 
 static void DOT_savegame (Stream *h) {
   int i, n;
   for (i = n = 0; i < MAXDOT; ++i) {
-    if (dot[i].t) {
+    if (dot.t[i]) {
       ++n;
     }
   }
   stream_write32(n, h);
   for (i = 0; i < MAXDOT; ++i) {
-    if (dot[i].t) {
-      stream_write32(dot[i].o.x, h);
-      stream_write32(dot[i].o.y, h);
-      stream_write32(dot[i].o.xv, h);
-      stream_write32(dot[i].o.yv, h);
-      stream_write32(dot[i].o.vx, h);
-      stream_write32(dot[i].o.vy, h);
-      stream_write32(dot[i].o.r, h);
-      stream_write32(dot[i].o.h, h);
-      stream_write8(dot[i].c, h);
-      stream_write8(dot[i].t, h);
+    if (dot.t[i]) {
+      stream_write32(dot.x[i], h);
+      stream_write32(dot.y[i], h);
+      stream_write32(dot.xv[i], h);
+      stream_write32(dot.yv[i], h);
+      stream_write32(dot.vx[i], h);
+      stream_write32(dot.vy[i], h);
+      stream_write32(0, h); // r
+      stream_write32(1, h); // h
+      stream_write8(dot.c[i], h);
+      stream_write8(dot.t[i], h);
     }
   }
 }
 
 static void DOT_loadgame (Stream *h) {
   int i, n;
-  n = stream_read32(h);
+  n = SAVE_count(h, MAXDOT, "dots");
   for (i = 0; i < n; i++) {
-    dot[i].o.x = stream_read32(h);
-    dot[i].o.y = stream_read32(h);
-    dot[i].o.xv = stream_read32(h);
-    dot[i].o.yv = stream_read32(h);
-    dot[i].o.vx = stream_read32(h);
-    dot[i].o.vy = stream_read32(h);
-    dot[i].o.r = stream_read32(h);
-    dot[i].o.h = stream_read32(h);
-    dot[i].c = stream_read8(h);
-    dot[i].t = stream_read8(h);
+    dot.x[i] = stream_read32(h);
+    dot.y[i] = stream_read32(h);
+    dot.xv[i] = stream_read32(h);
+    dot.yv[i] = stream_read32(h);
+    dot.vx[i] = stream_read32(h);
+    dot.vy[i] = stream_read32(h);
+    stream_read32(h); // r, always 0
+    stream_read32(h); // h, always 1
+    dot.c[i] = stream_read8(h);
+    dot.t[i] = stream_read8(h);
+    LV_put(dot_live, i, dot.t[i]);
   }
 }
 
@@ -99,13 +118,14 @@ static void FX_savegame (Stream *h) {
 
 static void FX_loadgame (Stream *h) {
   int i, n;
-  n = stream_read32(h);
+  n = SAVE_count(h, MAXFX, "effects");
   for (i = 0; i < n; i++) {
     fx[i].x = stream_read32(h);
     fx[i].y = stream_read32(h);
     fx[i].xv = stream_read32(h);
     fx[i].yv = stream_read32(h);
     fx[i].t = stream_read8(h);
+    LV_put(fx_live, i, fx[i].t);
     fx[i].s = stream_read8(h);
   }
 }
@@ -175,7 +195,7 @@ static void IT_savegame (Stream *h) {
 
 static void IT_loadgame (Stream *h) {
   int i, n;
-  n = stream_read32(h);
+  n = SAVE_count(h, MAXITEM, "items");
   for (i = 0; i < n; i++) {
     it[i].o.x = stream_read32(h);
     it[i].o.y = stream_read32(h);
@@ -186,6 +206,7 @@ static void IT_loadgame (Stream *h) {
     it[i].o.r = stream_read32(h);
     it[i].o.h = stream_read32(h);
     it[i].t = stream_read32(h);
+    LV_put(it_live, i, it[i].t);
     it[i].s = stream_read32(h);
   }
   itm_rtime = stream_read32(h);
@@ -211,17 +232,17 @@ static void MN_savegame (Stream *h) {
     stream_write8(mn[i].d, h);
     stream_write8(mn[i].st, h);
     stream_write8(mn[i].ftime, h);
-    stream_write32(mn[i].fobj, h);
-    stream_write32(mn[i].s, h);
-    stream_write32(0, h); // mn[i].ap useless, changed after load
-    stream_write32(mn[i].aim, h);
-    stream_write32(mn[i].life, h);
-    stream_write32(mn[i].pain, h);
-    stream_write32(mn[i].ac, h);
-    stream_write32(mn[i].tx, h);
-    stream_write32(mn[i].ty, h);
-    stream_write32(mn[i].ammo, h);
-    stream_write16(mn[i].atm, h);
+    stream_write32(MN_slot(mnc[i].fobj), h);
+    stream_write32(mnc[i].s, h);
+    stream_write32(0, h); // mnc[i].ap useless, changed after load
+    stream_write32(MN_slot(mnc[i].aim), h);
+    stream_write32(mnc[i].life, h);
+    stream_write32(mnc[i].pain, h);
+    stream_write32(mnc[i].ac, h);
+    stream_write32(mnc[i].tx, h);
+    stream_write32(mnc[i].ty, h);
+    stream_write32(mnc[i].ammo, h);
+    stream_write16(mnc[i].atm, h);
   }
   stream_write32(mnum, h);
   stream_write32(gsndt, h);
@@ -229,7 +250,9 @@ static void MN_savegame (Stream *h) {
 
 static void MN_loadgame (Stream *h) {
   int i, n, c;
-  n = stream_read32(h);
+  /* saves keep plain slots, with all counts at 0 they are handles again */
+  memset(mn_gen, 0, sizeof(mn_gen));
+  n = SAVE_count(h, MAXMN, "monsters");
   for (i = 0; i < n; i++) {
     mn[i].o.x = stream_read32(h);
     mn[i].o.y = stream_read32(h);
@@ -240,28 +263,29 @@ static void MN_loadgame (Stream *h) {
     mn[i].o.r = stream_read32(h);
     mn[i].o.h = stream_read32(h);
     mn[i].t = stream_read8(h);
+    LV_put(mn_live, i, mn[i].t);
     mn[i].d = stream_read8(h);
     mn[i].st = stream_read8(h);
     mn[i].ftime = stream_read8(h);
-    mn[i].fobj = stream_read32(h);
-    mn[i].s = stream_read32(h);
-    mn[i].ap = NULL; stream_read32(h); // useless, changed after loading
-    mn[i].aim = stream_read32(h);
-    mn[i].life = stream_read32(h);
-    mn[i].pain = stream_read32(h);
-    mn[i].ac = stream_read32(h);
-    mn[i].tx = stream_read32(h);
-    mn[i].ty = stream_read32(h);
-    mn[i].ammo = stream_read32(h);
-    mn[i].atm = stream_read16(h);
+    mnc[i].fobj = stream_read32(h);
+    mnc[i].s = stream_read32(h);
+    mnc[i].ap = NULL; stream_read32(h); // useless, changed after loading
+    mnc[i].aim = stream_read32(h);
+    mnc[i].life = stream_read32(h);
+    mnc[i].pain = stream_read32(h);
+    mnc[i].ac = stream_read32(h);
+    mnc[i].tx = stream_read32(h);
+    mnc[i].ty = stream_read32(h);
+    mnc[i].ammo = stream_read32(h);
+    mnc[i].atm = stream_read16(h);
   }
   mnum = stream_read32(h);
   gsndt = stream_read32(h);
   for (n = 0; n < MAXMN; n++) {
     if (mn[n].t) {
-      c = mn[n].ac;
+      c = mnc[n].ac;
       setst(n, mn[n].st);
-      mn[n].ac = c;
+      mnc[n].ac = c;
     }
   }
 }
@@ -390,20 +414,21 @@ static void SMK_savegame (Stream *h) {
       stream_write32(sm[i].xv, h);
       stream_write8(sm[i].t, h);
       stream_write8(sm[i].s, h);
-      stream_write16(sm[i].o, h);
+      stream_write16(MN_slot(sm[i].o), h);
     }
   }
 }
 
 static void SMK_loadgame (Stream *h) {
   int i, n;
-  n = stream_read32(h);
+  n = SAVE_count(h, MAXSMOK, "smoke puffs");
   for (i = 0; i < n; ++i) {
     sm[i].x = stream_read32(h);
     sm[i].y = stream_read32(h);
     sm[i].xv = stream_read32(h);
     sm[i].xv = stream_read32(h);
     sm[i].t = stream_read8(h);
+    LV_put(sm_live, i, sm[i].t);
     sm[i].s = stream_read8(h);
     sm[i].o = stream_read16(h);
   }
@@ -432,11 +457,12 @@ static void SW_savegame (Stream *h) {
 
 static void SW_loadgame (Stream *h) {
   int i, n;
-  n = stream_read32(h);
+  n = SAVE_count(h, MAXSW, "switches");
   for (i = 0; i < n; i++) {
     sw[i].x = stream_read8(h);
     sw[i].y = stream_read8(h);
     sw[i].t = stream_read8(h);
+    LV_put(sw_live, i, sw[i].t);
     sw[i].tm = stream_read8(h);
     sw[i].a = stream_read8(h);
     sw[i].b = stream_read8(h);
@@ -508,14 +534,14 @@ static void WP_savegame (Stream *h) {
     stream_write32(wp[i].o.h, h);
     stream_write8(wp[i].t, h);
     stream_write8(wp[i].s, h);
-    stream_write32(wp[i].own, h);
-    stream_write16(wp[i].target, h);
+    stream_write32(MN_slot(wpc[i].own), h);
+    stream_write16(MN_slot(wpc[i].target), h);
   }
 }
 
 static void WP_loadgame (Stream *h) {
   int i, n;
-  n = stream_read32(h);
+  n = SAVE_count(h, MAXWPN, "weapons");
   for (i = 0; i < n; i++) {
     wp[i].o.x = stream_read32(h);
     wp[i].o.y = stream_read32(h);
@@ -526,16 +552,20 @@ static void WP_loadgame (Stream *h) {
     wp[i].o.r = stream_read32(h);
     wp[i].o.h = stream_read32(h);
     wp[i].t = stream_read8(h);
+    LV_put(wp_live, i, wp[i].t);
     wp[i].s = stream_read8(h);
-    wp[i].own = stream_read32(h);
-    wp[i].target = stream_read16(h);
+    wpc[i].own = stream_read32(h);
+    wpc[i].target = stream_read16(h);
   }
 }
 
 void SAVE_save (Stream *w, const char name[24]) {
   assert(w != NULL);
   stream_write(name, 24, 1, w); // slot name
-  stream_write16(3, w); // version
+  stream_write16(SAVE_VERSION, w);
+#if POOL_SCALE > 1
+  stream_write16(POOL_SCALE, w);
+#endif
   G_savegame(w);
   W_savegame(w);
   DOT_savegame(w);
@@ -548,11 +578,33 @@ void SAVE_save (Stream *w, const char name[24]) {
   WP_savegame(w);
 }
 
+void SAVE_save_players (Stream *w) {
+  assert(w != NULL);
+  PL_savegame(w);
+}
+
+void SAVE_load_players (Stream *r) {
+  assert(r != NULL);
+  PL_loadgame(r);
+}
+
+/* saves from a larger POOL_SCALE build may hold more than our pools */
+static int SAVE_fits (Stream *h) {
+  int16_t version = stream_read16(h);
+  if (version == 3) {
+    return 1;
+  }
+#if POOL_SCALE > 1
+  if (version == 4) {
+    return stream_read16(h) <= POOL_SCALE;
+  }
+#endif
+  return 0;
+}
+
 void SAVE_load (Stream *h) {
-  int16_t version;
   stream_setpos(h, 24); // skip name
-  version = stream_read16(h);
-  if (version == 3) {
+  if (SAVE_fits(h)) {
     G_loadgame(h);
     W_loadgame(h);
     DOT_loadgame(h);
@@ -567,8 +619,6 @@ void SAVE_load (Stream *h) {
 }
 
 int SAVE_getname (Stream *r, char name[24]) {
-  int16_t version;
   stream_read(name, 24, 1, r);
-  version = stream_read16(r);
-  return version == 3;
+  return SAVE_fits(r);
 }
@@ -24,4 +24,8 @@ int  SAVE_getname (Stream *r, char name[24]);
 void SAVE_save (Stream *w, const char name[24]);
 void SAVE_load (Stream *r);
 
+/* players only, for demos */
+void SAVE_save_players (Stream *w);
+void SAVE_load_players (Stream *r);
+
 #endif /* SAVE_H_INCLUDED */
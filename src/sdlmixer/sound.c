@@ -297,6 +297,10 @@ void S_wait (void) {
   }
 }
 
+int S_playing (void) {
+  return devinit ? Mix_Playing(-1) : 0;
+}
+
 void S_done (void) {
   if (devinit) {
     // TODO free memory
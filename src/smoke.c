@@ -23,31 +23,36 @@
 #include "fx.h"
 #include "misc.h"
 #include "monster.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
 
 #define MAXSR 20
 
-smoke_t sm[MAXSMOK];
+#define sr_r (world->sm_sr_r)
+#define lsm (world->sm_last)
+#define burntm (world->sm_burntm)
 
-static int sr_r,sxr[MAXSR],syr[MAXSR];
-static int lsm;
+static int sxr[MAXSR],syr[MAXSR];
 
 static void *burnsnd;
-static int burntm=0;
 
 void SMK_init (void) {
   int i;
 
-  for(i=0;i<MAXSMOK;++i) {sm[i].t=0;}
+  for(i=0;i<MAXSMOK;++i) {sm[i].t=0;world->sm_moved[i]=0;}
+  LV_clear(sm_live,MAXSMOK);
   lsm=0;
   burntm=0;
+  sr_r=0;
 }
 
 void SMK_alloc (void) {
   int i;
   burnsnd=Z_getsnd("BURN");
   for(i=0;i<MAXSR;++i) {
-    sxr[i]=myrand(256*2+1)-256;
-    syr[i]=myrand(256*2+1)-256;
+    sxr[i]=RND_mod(RND_INIT,256*2+1)-256;
+    syr[i]=RND_mod(RND_INIT,256*2+1)-256;
   }
   sr_r=0;
 }
@@ -56,51 +61,82 @@ static void inclast(void) {
   if(++lsm>=MAXSMOK) lsm=0;
 }
 
-void SMK_act (void) {
-  int i,ox,oy;
-  static obj_t o;
+static void move (int i) {
+  int ox,oy;
 
-  if(burntm) --burntm;
-  for(i=0;i<MAXSMOK;++i) if(sm[i].t) {
-    if(sm[i].s) {
-      ox=sm[i].x;oy=sm[i].y;
-      sm[i].xv=Z_dec(sm[i].xv,20);
-      sm[i].yv=Z_dec(sm[i].yv,20);
-      sm[i].x+=sm[i].xv/2;sm[i].y+=sm[i].yv/2;
-      if(!Z_canfit(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
-        sm[i].x=ox;sm[i].y=oy;
-      }else if(Z_inwater(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
+  if(sm[i].s) {
+    ox=sm[i].x;oy=sm[i].y;
+    sm[i].xv=Z_dec(sm[i].xv,20);
+    sm[i].yv=Z_dec(sm[i].yv,20);
+    sm[i].x+=sm[i].xv/2;sm[i].y+=sm[i].yv/2;
+    if(Z_open(sm[i].x>>8,(sm[i].y>>8)+3,3,7)<0)
+      if(!Z_canfit(sm[i].x>>8,(sm[i].y>>8)+3,3,7) || Z_inwater(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
         sm[i].x=ox;sm[i].y=oy;
       }
-      ox=sm[i].x;oy=sm[i].y;
-      sm[i].x+=sm[i].xv/2;sm[i].y+=sm[i].yv/2;
-      if(!Z_canfit(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
+    ox=sm[i].x;oy=sm[i].y;
+    sm[i].x+=sm[i].xv/2;sm[i].y+=sm[i].yv/2;
+    if(Z_open(sm[i].x>>8,(sm[i].y>>8)+3,3,7)<0)
+      if(!Z_canfit(sm[i].x>>8,(sm[i].y>>8)+3,3,7) || Z_inwater(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
         sm[i].x=ox;sm[i].y=oy;
-      }else if(Z_inwater(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
-        sm[i].x=ox;sm[i].y=oy;
-      }
-      if(sm[i].o!=-3) {
-        o.x=sm[i].x>>8;o.y=sm[i].y>>8;
-        o.xv=sm[i].xv>>10;o.yv=sm[i].yv>>10;
-        o.vx=o.vy=0;
-        if(!(g_time&3)) Z_hit(&o,1,sm[i].o,HIT_FLAME);
       }
-    }else{
-      ox=sm[i].x;oy=sm[i].y;
-      sm[i].xv=Z_dec(sm[i].xv,20);
-      sm[i].yv=Z_dec(sm[i].yv,20);
-      sm[i].x+=sm[i].xv;sm[i].y+=sm[i].yv;
-      if(!Z_canfit(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
-        sm[i].x=ox;sm[i].y=oy;
-      }else if(Z_inwater(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
+  }else{
+    ox=sm[i].x;oy=sm[i].y;
+    sm[i].xv=Z_dec(sm[i].xv,20);
+    sm[i].yv=Z_dec(sm[i].yv,20);
+    sm[i].x+=sm[i].xv;sm[i].y+=sm[i].yv;
+    if(Z_open(sm[i].x>>8,(sm[i].y>>8)+3,3,7)<0)
+      if(!Z_canfit(sm[i].x>>8,(sm[i].y>>8)+3,3,7) || Z_inwater(sm[i].x>>8,(sm[i].y>>8)+3,3,7)) {
         sm[i].x=ox;sm[i].y=oy;
       }
-    }
+  }
+}
+
+static void burn (int i) {
+  static W_THREAD obj_t o;
+  int own;
+
+  if(sm[i].s && (own=MN_slot(sm[i].o))!=-3) {
+    o.x=sm[i].x>>8;o.y=sm[i].y>>8;
+    o.xv=sm[i].xv>>10;o.yv=sm[i].yv>>10;
+    o.vx=o.vy=0;
+    if(!(g_time&3)) Z_hit(&o,1,own,HIT_FLAME);
+  }
+}
+
+/* burning is left for SMK_settle, it hurts others and spawns,
+   sm_live keeps puffs that went out here until then */
+void SMK_move (int chunk) {
+  int i,n;
+
+  n=min((chunk+1)*SMK_CHUNK,MAXSMOK);
+  for(i=LV_next(sm_live,n,chunk*SMK_CHUNK);i<n;i=LV_next(sm_live,n,i+1)) {
+    move(i);
     --sm[i].t;
+    world->sm_moved[i]=1;
+  }
+}
+
+void SMK_settle (void) {
+  int i;
+
+  if(burntm) --burntm;
+  LV_EACH(i,sm_live,MAXSMOK) {
+    if(world->sm_moved[i]) {
+      burn(i);
+      // puff spawned over this slot while burning, whole step would count it down
+      if(!world->sm_moved[i]) --sm[i].t;
+      world->sm_moved[i]=0;
+    }else if(sm[i].t) {
+      // spawned after SMK_move
+      move(i);
+      burn(i);
+      --sm[i].t;
+    }
+    LV_put(sm_live,i,sm[i].t);
   }
 }
 
-static void SMK_add (int x, int y, int xv, int yv, byte t, byte s, short o) {
+static void SMK_add (int x, int y, int xv, int yv, byte t, byte s, int o) {
   int i;
 
   if(!Z_canfit(x>>8,(y>>8)+3,3,7)) return;
@@ -109,13 +145,15 @@ static void SMK_add (int x, int y, int xv, int yv, byte t, byte s, short o) {
   sm[i].x=x;sm[i].y=y;
   sm[i].xv=xv;sm[i].yv=yv;
   sm[i].t=t;sm[i].s=s;
-  sm[i].o=o;
+  LV_put(sm_live,i,t);
+  sm[i].o=MN_ref(o);
+  world->sm_moved[i]=0;
   inclast();
 }
 
 void SMK_gas (int x0, int y0, int xr, int yr, int xv, int yv, int k) {
   int i,x,y;
-  static int sxv,syv;
+  int sxv,syv;
 
   xv=-xv;yv=-yv;
   sxv=xv*k;syv=yv*k;
@@ -131,7 +169,7 @@ void SMK_gas (int x0, int y0, int xr, int yr, int xv, int yv, int k) {
 
 void SMK_flame (int x0, int y0, int ox, int oy, int xr, int yr, int xv, int yv, int k, int o) {
   int i,x,y;
-  static int sxv,syv;
+  int sxv,syv;
 
   sxv=xv*k;syv=yv*k;
   xv=xv-(ox<<8);yv=yv-(oy<<8);
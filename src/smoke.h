@@ -20,7 +20,9 @@
 
 #include "glob.h"
 
-#define MAXSMOK 500
+#define MAXSMOK (500 * POOL_SCALE)
+#define SMK_CHUNK 64 // puffs moved by one SMK_move
+#define SMK_CHUNKS ((MAXSMOK + SMK_CHUNK - 1) / SMK_CHUNK)
 
 #define SMSN 10
 #define FLSN 8
@@ -28,14 +30,13 @@
 typedef struct {
   int x, y, xv, yv;
   byte t, s;
-  short o;
+  int o; // handle, see MN_ref
 } smoke_t;
 
-extern smoke_t sm[MAXSMOK];
-
 void SMK_init (void);
 void SMK_alloc (void);
-void SMK_act (void);
+void SMK_move (int chunk); // may run in parallel, reads map only
+void SMK_settle (void); // after all SMK_move, burns in order
 void SMK_gas (int x0, int y0, int xr, int yr, int xv, int yv, int k);
 void SMK_flame (int x0, int y0, int ox, int oy, int xr, int yr, int xv, int yv, int k, int o);
 
@@ -0,0 +1,146 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "snap.h"
+#include <stdlib.h> // malloc
+#include <string.h>
+#include <assert.h>
+#include "glob.h"
+#include "world.h"
+#include "misc.h" // Z_remaptiles
+#include "bmap.h" // BM_regrid
+#include "error.h" // logo
+
+/*
+ * Whole world is kept in fixed size arrays, so a snapshot is one memcpy of
+ * world_t up to the map fields. Fields change only when doors and lifts
+ * move, they are kept apart and shared by consecutive snapshots until they
+ * differ. History belongs to the world it was taken from.
+ */
+
+typedef struct field_t {
+  byte f[FLDH][FLDW];
+  byte b[FLDH][FLDW];
+  byte t[FLDH][FLDW];
+} field_t;
+
+typedef struct snap_t {
+  byte state[W_STATE];
+  dword time;
+  int field; // index in fields
+} snap_t;
+
+typedef struct snap_ctx_t {
+  snap_t ring[SN_MAX];
+  int head; // next slot to write
+  int num; // valid snapshots behind head
+  /* every snapshot adds at most one, so SN_MAX is enough */
+  field_t fields[SN_MAX];
+  int fhead; // next slot to write
+  int fnum;
+} snap_ctx_t;
+
+static int same_field (const field_t *f) {
+  return memcmp(f->f, fld, sizeof(fld)) == 0
+      && memcmp(f->b, fldb, sizeof(fldb)) == 0
+      && memcmp(f->t, fldf, sizeof(fldf)) == 0;
+}
+
+static int store_field (snap_ctx_t *c) {
+  int last = (c->fhead + SN_MAX - 1) % SN_MAX;
+  field_t *f;
+  if (c->fnum > 0 && same_field(&c->fields[last])) {
+    return last;
+  }
+  f = &c->fields[c->fhead];
+  memcpy(f->f, fld, sizeof(fld));
+  memcpy(f->b, fldb, sizeof(fldb));
+  memcpy(f->t, fldf, sizeof(fldf));
+  last = c->fhead;
+  c->fhead = (c->fhead + 1) % SN_MAX;
+  c->fnum = min(c->fnum + 1, SN_MAX);
+  return last;
+}
+
+static void load_field (snap_ctx_t *c, int i) {
+  field_t *f = &c->fields[i];
+  memcpy(fld, f->f, sizeof(fld));
+  memcpy(fldb, f->b, sizeof(fldb));
+  memcpy(fldf, f->t, sizeof(fldf));
+  Z_remaptiles();
+  // drop copies made after this one, they are in the future now
+  c->fnum -= (c->fhead + SN_MAX - i - 1) % SN_MAX;
+  c->fhead = (i + 1) % SN_MAX;
+}
+
+void SN_alloc (void) {
+  assert(world != NULL);
+  if (world->snap == NULL) {
+    world->snap = malloc(sizeof(snap_ctx_t));
+    if (world->snap == NULL) {
+      logo("SN_alloc: not enough memory, rewind disabled\n");
+    }
+  }
+  SN_reset();
+}
+
+void SN_free (world_t *w) {
+  free(w->snap);
+  w->snap = NULL;
+}
+
+void SN_reset (void) {
+  snap_ctx_t *c = world->snap;
+  if (c != NULL) {
+    c->head = 0;
+    c->num = 0;
+    c->fhead = 0;
+    c->fnum = 0;
+  }
+}
+
+void SN_capture (void) {
+  snap_ctx_t *c = world->snap;
+  if (c != NULL && g_time % SN_STEP == 0) {
+    memcpy(c->ring[c->head].state, world, W_STATE);
+    c->ring[c->head].time = g_time;
+    c->ring[c->head].field = store_field(c);
+    c->head = (c->head + 1) % SN_MAX;
+    c->num = min(c->num + 1, SN_MAX);
+  }
+}
+
+int SN_rewind (void) {
+  snap_ctx_t *c = world->snap;
+  snap_t *s;
+  if (c == NULL) {
+    return 0;
+  }
+  if (c->num > 0 && c->ring[(c->head + SN_MAX - 1) % SN_MAX].time == g_time) {
+    // already there, drop it
+    c->head = (c->head + SN_MAX - 1) % SN_MAX;
+    c->num -= 1;
+  }
+  if (c->num == 0) {
+    return 0;
+  }
+  s = &c->ring[(c->head + SN_MAX - 1) % SN_MAX];
+  memcpy(world, s->state, W_STATE);
+  load_field(c, s->field);
+  BM_regrid();
+  pl1.drawst = 0xFF;
+  pl2.drawst = 0xFF;
+  return 1;
+}
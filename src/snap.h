@@ -0,0 +1,31 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAP_H_INCLUDED
+#define SNAP_H_INCLUDED
+
+#define SN_STEP 2 // ticks between snapshots
+#define SN_MAX 50 // snapshots kept, SN_MAX * SN_STEP * DELAY = 5 sec
+#define SN_KEY KEY_BACKSPACE // hold to rewind
+
+struct world_t;
+
+void SN_alloc (void); // keep history for current world
+void SN_free (struct world_t *w);
+void SN_reset (void); // forget history, level changed
+void SN_capture (void); // G_act, after simulation
+int  SN_rewind (void); // step one snapshot back, 0 when history is empty
+
+#endif /* SNAP_H_INCLUDED */
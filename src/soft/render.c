@@ -41,6 +41,9 @@
 #include "sound.h"
 #include "music.h"
 #include "system.h"
+#include "prof.h"
+#include "world.h"
+#include "live.h"
 
 #include "common/cp866.h"
 
@@ -93,6 +96,7 @@ static byte gamcor[5][64]={
 #define ANIT 5
 static int WD, HT;
 static int w_o, w_x, w_y;
+static int alpha; // interpolation alpha
 static vgaimg *walp[256];
 static int walh[256];
 static byte walani[256];
@@ -338,8 +342,8 @@ static void Z_drawmanspr (int x, int y, void *p, char d, byte color) {
   }
 }
 
-static void Z_drawfld (byte *fld, int bg) {
-    byte *p = fld;
+static void Z_drawfld (byte *f, int bg) {
+    byte *p = f;
     int x, y;
     for (y = 0; y < FLDH; y++) {
         for (x = 0; x < FLDW; x++) {
@@ -578,10 +582,11 @@ static int GM_draw (void) {
 /* --- dots --- */
 
 static void DOT_draw (void) {
-  int i;
-  for (i = 0; i < MAXDOT; i++) {
-    if (dot[i].t) {
-      V_dot(dot[i].o.x - w_x + WD / 2, dot[i].o.y - w_y + HT / 2 + 1 + w_o, dot[i].c);
+  int i, x, y;
+  LV_EACH(i, dot_live, MAXDOT) {
+    if (dot.t[i]) {
+      W_lerp(dot.x[i], dot.y[i], dot.px[i], dot.py[i], alpha, &x, &y);
+      V_dot(x - w_x + WD / 2, y - w_y + HT / 2 + 1 + w_o, dot.c[i]);
     }
   }
 }
@@ -589,8 +594,8 @@ static void DOT_draw (void) {
 /* --- items --- */
 
 static void IT_draw (void) {
-  int i, s;
-  for (i = 0; i < MAXITEM; ++i) {
+  int i, s, x, y;
+  LV_EACH(i, it_live, MAXITEM) {
     s = -1;
     if (it[i].t && it[i].s >= 0) {
       switch(it[i].t & 0x7FFF) {
@@ -634,7 +639,8 @@ static void IT_draw (void) {
       }
     }
     if (s >= 0) {
-      Z_drawspr(it[i].o.x, it[i].o.y, item_spr[s], item_sprd[s]);
+      W_lerpobj(&it[i].o, alpha, &x, &y);
+      Z_drawspr(x, y, item_spr[s], item_sprd[s]);
     }
   }
 }
@@ -668,6 +674,7 @@ static void PL_draw (player_t *p) {
   int w = 0;
   int wx = 0;
   int wy = 0;
+  int x, y;
   switch (p->st) {
     case STAND:
       if (p->f & PLF_FIRE) {
@@ -715,11 +722,12 @@ static void PL_draw (player_t *p) {
   if (p->wpn == 0) {
     w = 0;
   }
+  W_lerpobj(&p->o, alpha, &x, &y);
   if (w) {
-    Z_drawspr(p->o.x + wx, p->o.y + wy, plr_wpn[p->wpn][w - 'A'], p->d);
+    Z_drawspr(x + wx, y + wy, plr_wpn[p->wpn][w - 'A'], p->d);
   }
   if (s) {
-    Z_drawmanspr(p->o.x, p->o.y, plr_spr[(s - 'A') * 2 + p->d], plr_sprd[(s - 'A') * 2 + p->d], p->color);
+    Z_drawmanspr(x, y, plr_spr[(s - 'A') * 2 + p->d], plr_sprd[(s - 'A') * 2 + p->d], p->color);
   }
 }
 
@@ -781,25 +789,26 @@ static void PL_drawst (player_t *p) {
 
 static void MN_draw (void) {
   enum {SLEEP, GO, RUN, CLIMB, DIE, DEAD, ATTACK, SHOOT, PAIN, WAIT, REVIVE, RUNOUT}; // copypasted from monster.c!
-  int i;
-  for (i = 0; i < MAXMN; i++) {
+  int i, x, y;
+  LV_EACH(i, mn_live, MAXMN) {
     if (mn[i].t) {
+      W_lerpobj(&mn[i].o, alpha, &x, &y);
       if (mn[i].t >= MN_PL_DEAD) {
-        Z_drawmanspr(mn[i].o.x, mn[i].o.y, pl_spr[mn[i].t - MN_PL_DEAD], 0, mn[i].d);
+        Z_drawmanspr(x, y, pl_spr[mn[i].t - MN_PL_DEAD], 0, mn[i].d);
         continue;
       }
       if ((mn[i].t != MN_SOUL && mn[i].t != MN_PAIN) || mn[i].st != DEAD) {
         if (mn[i].t != MN_MAN) {
-          Z_drawspr(mn[i].o.x, mn[i].o.y, mn_spr[mn[i].t - 1][(mn[i].ap[mn[i].ac] - 'A') * 2 + mn[i].d], mn_sprd[mn[i].t - 1][(mn[i].ap[mn[i].ac] - 'A') * 2 + mn[i].d]);
+          Z_drawspr(x, y, mn_spr[mn[i].t - 1][(mnc[i].ap[mnc[i].ac] - 'A') * 2 + mn[i].d], mn_sprd[mn[i].t - 1][(mnc[i].ap[mnc[i].ac] - 'A') * 2 + mn[i].d]);
         } else {
-          if (mn[i].ap[mn[i].ac] == 'E' || mn[i].ap[mn[i].ac] == 'F') {
-            Z_drawspr(mn[i].o.x, mn[i].o.y, mn_sgun[mn[i].ap[mn[i].ac] - 'E'], mn[i].d);
+          if (mnc[i].ap[mnc[i].ac] == 'E' || mnc[i].ap[mnc[i].ac] == 'F') {
+            Z_drawspr(x, y, mn_sgun[mnc[i].ap[mnc[i].ac] - 'E'], mn[i].d);
           }
-          Z_drawmanspr(mn[i].o.x, mn[i].o.y, mn_spr[mn[i].t - 1][(mn[i].ap[mn[i].ac] - 'A') * 2 + mn[i].d], mn_sprd[mn[i].t - 1][(mn[i].ap[mn[i].ac] - 'A') * 2 + mn[i].d], MANCOLOR);
+          Z_drawmanspr(x, y, mn_spr[mn[i].t - 1][(mnc[i].ap[mnc[i].ac] - 'A') * 2 + mn[i].d], mn_sprd[mn[i].t - 1][(mnc[i].ap[mnc[i].ac] - 'A') * 2 + mn[i].d], MANCOLOR);
         }
       }
       if (mn[i].t == MN_VILE && mn[i].st == SHOOT) {
-        Z_drawspr(mn[i].tx, mn[i].ty, mn_fspr[mn[i].ac / 3], 0);
+        Z_drawspr(mnc[i].tx, mnc[i].ty, mn_fspr[mnc[i].ac / 3], 0);
       }
     }
   }
@@ -810,7 +819,7 @@ static void MN_draw (void) {
 static void WP_draw (void) {
   enum {NONE, ROCKET, PLASMA, APLASMA, BALL1, BALL2, BALL7, BFGBALL, BFGHIT, MANF, REVF, FIRE}; // copypasted from weapons.c!
   int i, s, d, x, y;
-  for (i = 0; i < MAXWPN; ++i) {
+  LV_EACH(i, wp_live, MAXWPN) {
     s = -1;
     d = 0;
     switch (wp[i].t) {
@@ -889,7 +898,8 @@ static void WP_draw (void) {
         break;
     }
     if (s >= 0) {
-      Z_drawspr(wp[i].o.x, wp[i].o.y, wp_spr[s * 2 + d], wp_sprd[s * 2 + d]);
+      W_lerpobj(&wp[i].o, alpha, &x, &y);
+      Z_drawspr(x, y, wp_spr[s * 2 + d], wp_sprd[s * 2 + d]);
     }
   }
 }
@@ -898,7 +908,7 @@ static void WP_draw (void) {
 
 static void SMK_draw (void) {
   int i, s;
-  for (i = 0; i < MAXSMOK; ++i) {
+  LV_EACH(i, sm_live, MAXSMOK) {
     if (sm[i].t) {
       switch (sm[i].s) {
         case 0:
@@ -929,7 +939,7 @@ static void SMK_draw (void) {
 static void FX_draw (void) {
   enum {NONE, TFOG, IFOG, BUBL}; // copypasted from fx.c
   int i, s;
-  for (i = 0; i < MAXFX; ++i) {
+  LV_EACH(i, fx_live, MAXFX) {
     s = -1;
     switch (fx[i].t) {
       case TFOG:
@@ -1008,6 +1018,15 @@ static void W_draw(void) {
   }
 }
 
+/* --- profiler --- */
+
+#ifdef PROFILER
+static void PF_text (int x, int y, const char *s) {
+  Z_gotoxy(x, y);
+  Z_printsf("%s", s);
+}
+#endif
+
 /* --- game --- */
 
 #define PL_FLASH 90
@@ -1018,8 +1037,8 @@ static void drawview (player_t *p) {
   } else if (p->looky > SCRH / 4) {
     p->looky = SCRH / 4;
   }
-  w_x = p->o.x;
-  w_y = p->o.y - 12 + p->looky;
+  W_lerpobj(&p->o, alpha, &w_x, &w_y);
+  w_y = w_y - 12 + p->looky;
   W_draw();
   PL_drawst(p);
 }
@@ -1044,8 +1063,10 @@ static void pl_info (player_t *p, int y) {
 }
 
 static void W_act (void) {
+  static dword t;
   int i, a;
-  if (g_time % 3 == 0) {
+  if (g_time != t && g_time % 3 == 0) {
+    t = g_time; // R_draw called many times per tick
     for (i = 1; i < 256; i++) {
       a = walani[i];
       if (a != 0) {
@@ -1059,9 +1080,10 @@ static void W_act (void) {
   }
 }
 
-void R_draw (void) {
+void R_draw (int a) {
   int h;
-  word hr, mn, sc;
+  word hr, mi, sc;
+  alpha = a;
   W_act();
   switch (g_st) {
     case GS_ENDANIM:
@@ -1088,9 +1110,9 @@ void R_draw (void) {
       V_pic(0, 0, scrnh[1]);
       Z_gotoxy(60, 20);
       Z_printbf("LEVEL COMPLETE");
-      Z_calc_time(g_time, &hr, &mn, &sc);
+      Z_calc_time(g_time, &hr, &mi, &sc);
       Z_gotoxy(115, 40);
-      Z_printbf("TIME %u:%02u:%02u", hr, mn, sc);
+      Z_printbf("TIME %u:%02u:%02u", hr, mi, sc);
       h = 60;
       if (_2pl) {
         Z_gotoxy(80, h);
@@ -1164,6 +1186,9 @@ void R_draw (void) {
   }
   V_center(0);
   V_setrect(0, SCRW, 0, SCRH);
+#ifdef PROFILER
+  PF_draw(PF_text);
+#endif
   GM_draw();
   V_copytoscr(0, SCRW, 0, SCRH);
 }
@@ -1537,7 +1562,7 @@ static int video_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
   static int vmode;
   const videomode_t *v;
   enum { VIDEOMODE, FULLSCREEN, APPLY, __NUM__ };
-  static const simple_menu_t sm = {
+  static const simple_menu_t smenu = {
     GM_BIG, "Video", NULL,
     {
       { "Mode: ", NULL },
@@ -1587,7 +1612,7 @@ static int video_menu_handler (menu_msg_t *msg, const menu_t *m, int i) {
       case GM_SELECT: R_set_videomode(w, h, fullscreen); return 1;
     }
   }
-  return simple_menu_handler(msg, i, __NUM__, &sm, &cur);
+  return simple_menu_handler(msg, i, __NUM__, &smenu, &cur);
 }
 
 const menu_t *R_menu (void) {
@@ -1664,3 +1689,7 @@ int R_get_swp (int n) {
   assert(n >= 0 && n < 256);
   return walswp[n];
 }
+
+int R_atlas_pages (void) {
+  return 0; // no atlas, sprites are drawn from wad data
+}
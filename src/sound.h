@@ -60,4 +60,7 @@ void S_volume (int v);
 // Wait before all sounds end playing
 void S_wait (void);
 
+// Number of channels playing now
+int S_playing (void);
+
 #endif /* SOUND_H_INCLUDED */
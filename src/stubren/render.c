@@ -31,7 +31,7 @@ void R_init (void) {
   // stub
 }
 
-void R_draw (void) {
+void R_draw (int alpha) {
   // stub
 }
 
@@ -74,3 +74,7 @@ void R_end_load (void) {
 void R_loadsky (int sky) {
   // stub
 }
+
+int R_atlas_pages (void) {
+  return 0;
+}
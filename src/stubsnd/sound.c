@@ -112,3 +112,7 @@ void S_volume (int v) {
 void S_wait (void) {
 
 }
+
+int S_playing (void) {
+  return 0;
+}
@@ -17,6 +17,7 @@
 
 #include "glob.h"
 #include <string.h>
+#include <assert.h>
 #include "view.h"
 #include "bmap.h"
 #include "switch.h"
@@ -27,13 +28,13 @@
 #include "game.h"
 #include "monster.h"
 #include "render.h"
+#include "world.h"
+#include "live.h"
 
-int sw_secrets;
-sw_t sw[MAXSW];
+#define swsnd (world->sw_swsnd)
 
 static void *sndswn, *sndswx, *sndnoway, *sndbdo, *sndbdc, *sndnotele;
-static int swsnd;
-static byte cht, chto, chf, f_ch;
+static W_THREAD byte cht, chto, chf, f_ch;
 
 void SW_alloc (void) {
   sndswn=Z_getsnd("SWTCHN");
@@ -49,23 +50,41 @@ void SW_init (void) {
   for (i = 0; i < MAXSW; i++) {
     sw[i].t = 0;
   }
+  LV_clear(sw_live, MAXSW);
   swsnd = 0;
 }
 
+/* a span pushes at most one seed per cell above and below it, every
+   cell is filled once: twice the field is enough */
+static W_THREAD byte seed[FLDW*FLDH*2][2];
+
+/* scanline fill of cht cells around x, y with chto */
 static void door(byte x,byte y) {
-  byte ex;
+  int n,i,j,ex,x0,y0,x1,y1;
 
   if(x>=FLDW || y>=FLDH) return;
   if(fld[y][x]!=cht) return;
-  ex=x+1;
-  for(;x && fld[y][x-1]==cht;--x);
-  for(;ex<FLDW && fld[y][ex]==cht;++ex);
-  memset(fld[y]+x,chto,ex-x);
-  if(f_ch) memset(fldf[y]+x,chf,ex-x);
-  for(;x<ex;++x) {
-	door(x,y-1);
-	door(x,y+1);
+  x0=x1=x;y0=y1=y;
+  seed[0][0]=x;seed[0][1]=y;n=1;
+  while(n>0) {
+	x=seed[--n][0];y=seed[n][1];
+	if(fld[y][x]!=cht) continue;
+	ex=x+1;
+	for(;x && fld[y][x-1]==cht;--x);
+	for(;ex<FLDW && fld[y][ex]==cht;++ex);
+	memset(fld[y]+x,chto,ex-x);
+	if(f_ch) memset(fldf[y]+x,chf,ex-x);
+	x0=min(x0,x);x1=max(x1,ex-1);
+	y0=min(y0,y);y1=max(y1,y);
+	for(j=y-1;j<=y+1;j+=2) if(j>=0 && j<FLDH)
+	  for(i=x;i<ex;++i)
+		if(fld[j][i]==cht && (i==x || fld[j][i-1]!=cht)) {
+		  assert(n<FLDW*FLDH*2);
+		  seed[n][0]=i;seed[n++][1]=j;
+		}
   }
+  Z_retile(x0,y0,x1,y1);
+  BM_dirty(x0,y0,x1,y1);
 }
 
 void Z_water_trap (obj_t *o) {
@@ -86,11 +105,15 @@ void Z_water_trap (obj_t *o) {
 }
 
 void Z_untrap (byte t) {
-  byte *p;
-  word n;
+  int x,y,x0,y0,x1,y1;
 
-  for(p=(byte*)fld,n=FLDW*FLDH;n;--n,++p)
-	if(*p==255) *p=t;
+  if(!Z_traps(&x0,&y0,&x1,&y1)) return;
+  x0/=CELW;y0/=CELH;x1/=CELW;y1/=CELH;
+  for(y=y0;y<=y1;++y)
+	for(x=x0;x<=x1 && (x=Z_nextcell(ZR_TRAP,y,x,x1))>=0;++x)
+	  fld[y][x]=t;
+  Z_retile(x0,y0,x1,y1);
+  BM_dirty(x0,y0,x1,y1);
 }
 
 static void opendoor(int i) {
@@ -101,7 +124,7 @@ static void opendoor(int i) {
   cht=2;chto=3;chf=0;f_ch=1;
   door(sw[i].a,sw[i].b);
   fldf[sw[i].b][sw[i].a]=j;
-  fld_need_remap=1;
+  Z_retile(sw[i].a,sw[i].b,sw[i].a,sw[i].b);
 }
 
 static int shutdoor(int i) {
@@ -115,11 +138,11 @@ static int shutdoor(int i) {
 	chto=3;chf=0;f_ch=1;
 	door(sw[i].a,sw[i].b);
 	fldf[sw[i].b][sw[i].a]=j;
+	Z_retile(sw[i].a,sw[i].b,sw[i].a,sw[i].b);
 	return 0;
   }
   chto=2;
   door(sw[i].a,sw[i].b);
-  fld_need_remap=1;
   swsnd=Z_sound(sndbdc,128);
   return 1;
 }
@@ -128,7 +151,7 @@ void SW_act (void) {
   int i;
 
   if(swsnd) --swsnd;
-  for(i=0;i<MAXSW;++i) if(sw[i].t) {
+  LV_EACH(i,sw_live,MAXSW) {
     if(sw[i].tm) --sw[i].tm;
     switch(sw[i].t) {
       case SW_DOOR5: case SW_DOOR: case SW_SHUTDOOR:
@@ -155,7 +178,7 @@ static int doortime(int t) {
 void SW_cheat_open (void) {
   int i;
 
-  for(i=0;i<MAXSW;++i) if(sw[i].t && !sw[i].tm) switch(sw[i].t) {
+  LV_EACH(i,sw_live,MAXSW) if(!sw[i].tm) switch(sw[i].t) {
 	case SW_DOOR: case SW_DOOR5:
 	case SW_OPENDOOR:
 	  if(fld[sw[i].b][sw[i].a]!=2) break;
@@ -169,7 +192,8 @@ int SW_press (int x, int y, int r, int h, byte t, int o) {
 
   sx=(x-r)/CELW;sy=(y-h+1)/CELH;
   x=(x+r)/CELW;y/=CELH;
-  for(i=p=0;i<MAXSW;++i) if(sw[i].t && !sw[i].tm) {
+  p=0;
+  LV_EACH(i,sw_live,MAXSW) if(!sw[i].tm) {
     if(sw[i].x>=sx && sw[i].x<=x && sw[i].y>=sy && sw[i].y<=y && ((sw[i].f&0x8F)&t)) {
       if(sw[i].f&0x70) if((sw[i].f&(t&0x70))!=(sw[i].f&0x70)) continue;
       switch(sw[i].t) {
@@ -219,7 +243,6 @@ int SW_press (int x, int y, int r, int h, byte t, int o) {
 		  Z_chktrap(1,100,-3,HIT_TRAP);
 		  cht=255;chto=2;
 		  door(sw[i].a,sw[i].b);
-		  fld_need_remap=1;
 		  swsnd=Z_sound(sndswn,128);
 		  sw[i].tm=1;sw[i].d=20;
 		  break;
@@ -230,7 +253,6 @@ int SW_press (int x, int y, int r, int h, byte t, int o) {
 		    cht=9;chto=10;f_ch=0;
 		  }else break;
 		  door(sw[i].a,sw[i].b);
-		  fld_need_remap=1;
 		  swsnd=Z_sound(sndswx,128);
 		  sw[i].tm=9;
 		  break;
@@ -238,7 +260,6 @@ int SW_press (int x, int y, int r, int h, byte t, int o) {
 		  if(fld[sw[i].b][sw[i].a]!=10) break;
 		  cht=10;chto=9;f_ch=0;
 		  door(sw[i].a,sw[i].b);
-		  fld_need_remap=1;
 		  swsnd=Z_sound(sndswx,128);
 		  sw[i].tm=1;
 		  break;
@@ -246,7 +267,6 @@ int SW_press (int x, int y, int r, int h, byte t, int o) {
 		  if(fld[sw[i].b][sw[i].a]!=9) break;
 		  cht=9;chto=10;f_ch=0;
 		  door(sw[i].a,sw[i].b);
-		  fld_need_remap=1;
 		  swsnd=Z_sound(sndswx,128);
 		  sw[i].tm=1;
 		  break;
@@ -254,10 +274,11 @@ int SW_press (int x, int y, int r, int h, byte t, int o) {
 		  if(o!=-1 && o!=-2) break;
 		  if(o==-1) ++pl1.secrets;
 		  else ++pl2.secrets;
-		  sw[i].tm=1;sw[i].t=0;break;
+		  sw[i].tm=1;sw[i].t=0;LV_put(sw_live,i,0);break;
       }
       if (sw[i].tm != 0) {
         R_switch_texture(sw[i].x, sw[i].y);
+        Z_retile(sw[i].x, sw[i].y, sw[i].x, sw[i].y);
         p = 1;
       }
       if(sw[i].tm==1) sw[i].tm=0;
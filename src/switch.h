@@ -35,9 +35,6 @@ typedef struct {
   byte f;
 } sw_t;
 
-extern int sw_secrets;
-extern sw_t sw[MAXSW];
-
 void SW_alloc (void);
 void SW_init (void);
 void Z_water_trap (obj_t *o);
@@ -24,6 +24,7 @@ typedef struct cfg_t {
   const char *cfg;
   void *p;
   byte t;
+  int n; // Y_STRING: size of buffer at p
 } cfg_t;
 
 typedef struct videomode_size_t {
@@ -59,4 +60,8 @@ void Y_repaint (void);
 void Y_enable_text_input (void);
 void Y_disable_text_input (void);
 
+/* timer, used where POSIX clocks are missing */
+dword Y_get_ticks (void); // ms
+void Y_delay (dword ms);
+
 #endif /* SYSTEM_H_INCLUDED */
@@ -34,12 +34,11 @@
 #include "map.h"
 #include "sound.h"
 #include "render.h"
+#include "game.h"
+#include "world.h"
 
-int sky_type=1;
-dword walf[256];
-byte fldb[FLDH][FLDW];
-byte fldf[FLDH][FLDW];
-byte fld[FLDH][FLDW];
+#define W_NOPREV 0x7FFFFFFF // slot was free at previous tick
+#define W_SNAP 64 // do not interpolate longer jumps (teleports, respawns)
 
 void W_init (void) {
   DOT_init();
@@ -52,3 +51,42 @@ void W_init (void) {
   MN_init();
   R_loadsky(1);
 }
+
+static void store (obj_t *o, int live) {
+  o->px = live ? o->x : W_NOPREV;
+  o->py = o->y;
+}
+
+/* remember positions of all objects before tick, renderer interpolates them */
+void W_store (void) {
+  int i;
+  for (i = 0; i < MAXDOT; i++) {
+    dot.px[i] = dot.t[i] ? dot.x[i] : W_NOPREV;
+    dot.py[i] = dot.y[i];
+  }
+  for (i = 0; i < MAXITEM; i++) {
+    store(&it[i].o, it[i].t);
+  }
+  for (i = 0; i < MAXMN; i++) {
+    store(&mn[i].o, mn[i].t);
+  }
+  for (i = 0; i < MAXWPN; i++) {
+    store(&wp[i].o, wp[i].t);
+  }
+  store(&pl1.o, 1);
+  store(&pl2.o, _2pl);
+}
+
+void W_lerp (int x, int y, int px, int py, int alpha, int *rx, int *ry) {
+  if (px == W_NOPREV || abs(x - px) > W_SNAP || abs(y - py) > W_SNAP) {
+    *rx = x;
+    *ry = y;
+  } else {
+    *rx = px + (x - px) * alpha / W_ALPHA;
+    *ry = py + (y - py) * alpha / W_ALPHA;
+  }
+}
+
+void W_lerpobj (const obj_t *o, int alpha, int *x, int *y) {
+  W_lerp(o->x, o->y, o->px, o->py, alpha, x, y);
+}
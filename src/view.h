@@ -27,6 +27,8 @@
 #define MAXTXW 16
 #define MAXTXH 8
 
+#define W_ALPHA 256 // render alpha of fully simulated tick, see R_draw
+
 enum {
   HIT_SOME, HIT_ROCKET, HIT_BFG, HIT_TRAP, HIT_WATER, HIT_ELECTRO, HIT_FLAME
 };
@@ -36,19 +38,18 @@ enum {
   GS_BVIDEO, GS_EVIDEO, GS_END3ANIM
 };
 
+/* x and y stay int, a wall snap at the left map edge can put x near 65536 */
 typedef struct {
   int x, y;		// coordinates
-  int xv, yv;		// velocity
-  int vx, vy;
-  int r, h;		// radius, height
+  short xv, yv;		// velocity
+  short vx, vy;
+  short r, h;		// radius, height
+  int px, py;		// coordinates at previous tick, see W_store
 } obj_t;
 
-extern int sky_type;
-extern dword walf[256];
-extern byte fldb[FLDH][FLDW];
-extern byte fldf[FLDH][FLDW];
-extern byte fld[FLDH][FLDW];
-
 void W_init (void);
+void W_store (void);
+void W_lerp (int x, int y, int px, int py, int alpha, int *rx, int *ry);
+void W_lerpobj (const obj_t *o, int alpha, int *x, int *y);
 
 #endif /* VIEW_H_INCLUDED */
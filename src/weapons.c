@@ -28,15 +28,30 @@
 #include "player.h"
 #include "monster.h"
 #include "switch.h"
+#include "rnd.h"
+#include "world.h"
+#include "live.h"
 
 enum{NONE=0,ROCKET,PLASMA,APLASMA,BALL1,BALL2,BALL7,BFGBALL,BFGHIT,
      MANF,REVF,FIRE};
 
-weapon_t wp[MAXWPN];
 
 static void *snd[14];
 static void throw(int,int,int,int,int,int,int,int);
 
+/* lowest free slot given to t, -1 if all are in use */
+static int take(int t) {
+  int i;
+
+  if((i=LV_free(wp_live,MAXWPN))>=MAXWPN) return -1;
+  wp[i].t=t;LV_put(wp_live,i,t);
+  return i;
+}
+
+static void release(int i) {
+  wp[i].t=NONE;LV_put(wp_live,i,NONE);
+}
+
 void WP_alloc (void) {
   int i;
   static char nm[14][6]={
@@ -62,20 +77,22 @@ void WP_init (void) {
   int i;
 
   for(i=0;i<MAXWPN;++i) wp[i].t=NONE;
+  LV_clear(wp_live,MAXWPN);
 }
 
 void WP_act (void) {
-  int i,st;
-  static obj_t o;
+  int i,st,own;
+  static W_THREAD obj_t o;
 
-  for(i=0;i<MAXWPN;++i) if(wp[i].t) {
+  LV_EACH(i,wp_live,MAXWPN) {
 	if(wp[i].t==ROCKET || wp[i].t==REVF)
 	  SMK_gas(wp[i].o.x+Z_sign(wp[i].o.xv)*2,
 	    wp[i].o.y-wp[i].o.h/2,3,3,
 	    wp[i].o.xv+wp[i].o.vx,wp[i].o.yv+wp[i].o.vy,64
 	  );
-	--wp[i].o.yv;st=Z_moveobj(&wp[i].o);
-	if(st&Z_FALLOUT) {wp[i].t=0;continue;}
+	own=MN_slot(wpc[i].own);
+	--wp[i].o.yv;st=Z_moveobj(&wp[i].o,&world->wp_env[i]);
+	if(st&Z_FALLOUT) {release(i);continue;}
 	if(st&Z_HITWATER) switch(wp[i].t) {
 	  case PLASMA: case APLASMA:
 	  case BFGBALL:
@@ -85,59 +102,59 @@ void WP_act (void) {
 	}
 	switch(wp[i].t) {
 	  case REVF:
-		if(Z_getobjpos(wp[i].target,&o))
+		if(Z_getobjpos(wpc[i].target,&o))
 		  throw(i,wp[i].o.x,wp[i].o.y-2,o.x+o.xv+o.vx,o.y+o.yv+o.vy,2,5,12);
 	  case ROCKET:
-		if(wp[i].s>=2) {if(++wp[i].s>=8) wp[i].t=0; break;}
+		if(wp[i].s>=2) {if(++wp[i].s>=8) release(i); break;}
 		if(st&Z_HITAIR) Z_set_speed(&wp[i].o,12);
 		if(st&(Z_HITWALL|Z_HITCEIL|Z_HITLAND)) {
 		  wp[i].s=2;wp[i].o.xv=wp[i].o.yv=0;Z_sound(snd[4],128);
-		  Z_explode(wp[i].o.x,wp[i].o.y,30,wp[i].own);break;}
-		else if(Z_hit(&wp[i].o,10,wp[i].own,HIT_SOME)) {
+		  Z_explode(wp[i].o.x,wp[i].o.y,30,own);break;}
+		else if(Z_hit(&wp[i].o,10,own,HIT_SOME)) {
 		  wp[i].s=2;wp[i].o.xv=wp[i].o.yv=0;Z_sound(snd[4],128);
-		  Z_explode(wp[i].o.x,wp[i].o.y-wp[i].o.h/2,30,wp[i].own);break;}
-		bfg_fly(wp[i].o.x,wp[i].o.y-wp[i].o.h/2,wp[i].own);
+		  Z_explode(wp[i].o.x,wp[i].o.y-wp[i].o.h/2,30,own);break;}
+		bfg_fly(wp[i].o.x,wp[i].o.y-wp[i].o.h/2,own);
 		break;
 	  case PLASMA:
 	  case APLASMA:
 		if(st&Z_INWATER) {
 		  Z_sound(snd[12],128);
 		  Z_water_trap(&wp[i].o);
-		  Z_chktrap(1,10,wp[i].own,HIT_ELECTRO);
+		  Z_chktrap(1,10,own,HIT_ELECTRO);
 		  Z_untrap(5);
-		  wp[i].t=0;break;
+		  release(i);break;
 		}
 	  case BALL1:
 	  case BALL7:
 	  case BALL2:
 	  case MANF:
 		if(wp[i].s>=2)
-		  {if(++wp[i].s>=((wp[i].t==BALL1 || wp[i].t==BALL7 || wp[i].t==BALL2 || wp[i].t==MANF)?8:12)) wp[i].t=0; break;}
+		  {if(++wp[i].s>=((wp[i].t==BALL1 || wp[i].t==BALL7 || wp[i].t==BALL2 || wp[i].t==MANF)?8:12)) release(i); break;}
 		if(st&Z_HITAIR) Z_set_speed(&wp[i].o,16);
 		if(st&(Z_HITWALL|Z_HITCEIL|Z_HITLAND))
 		  {wp[i].s=2;wp[i].o.xv=wp[i].o.yv=0;Z_sound(snd[7],128);break;}
-		else if(Z_hit(&wp[i].o,(wp[i].t==BALL7 || wp[i].t==MANF)?40:((wp[i].t==BALL2)?20:5),wp[i].own,HIT_SOME))
+		else if(Z_hit(&wp[i].o,(wp[i].t==BALL7 || wp[i].t==MANF)?40:((wp[i].t==BALL2)?20:5),own,HIT_SOME))
 		  {wp[i].s=2;wp[i].o.xv=wp[i].o.yv=0;Z_sound(snd[7],128);break;}
 		wp[i].s^=1;break;
 	  case BFGBALL:
 		if(st&Z_INWATER) {
 		  Z_sound(snd[8],40);Z_sound(snd[13],128);
 		  Z_water_trap(&wp[i].o);
-		  Z_chktrap(1,1000,wp[i].own,HIT_ELECTRO);
+		  Z_chktrap(1,1000,own,HIT_ELECTRO);
 		  Z_untrap(5);
-		  wp[i].t=0;break;
+		  release(i);break;
 		}
-		if(wp[i].s>=2) {if(++wp[i].s>=14) wp[i].t=0; break;}
+		if(wp[i].s>=2) {if(++wp[i].s>=14) release(i); break;}
 		else if(st&(Z_HITWALL|Z_HITCEIL|Z_HITLAND)) {
-		  Z_bfg9000(wp[i].o.x,wp[i].o.y,wp[i].own);
+		  Z_bfg9000(wp[i].o.x,wp[i].o.y,own);
 		  wp[i].s=2;wp[i].o.xv=wp[i].o.yv=0;Z_sound(snd[8],128);break;}
-		else if(Z_hit(&wp[i].o,100,wp[i].own,HIT_BFG)) {
-		  Z_bfg9000(wp[i].o.x,wp[i].o.y,wp[i].own);
+		else if(Z_hit(&wp[i].o,100,own,HIT_BFG)) {
+		  Z_bfg9000(wp[i].o.x,wp[i].o.y,own);
 		  wp[i].s=2;wp[i].o.xv=wp[i].o.yv=0;Z_sound(snd[8],128);break;}
-		bfg_fly(wp[i].o.x,wp[i].o.y-wp[i].o.h/2,wp[i].own);
+		bfg_fly(wp[i].o.x,wp[i].o.y-wp[i].o.h/2,own);
 		wp[i].s^=1;break;
 	  case BFGHIT:
-		if(++wp[i].s>=8) wp[i].t=0;
+		if(++wp[i].s>=8) release(i);
 		break;
 	  default: break;
 	}
@@ -229,119 +246,99 @@ static void throw(int i,int x,int y,int xd,int yd,int r,int h,int s) {
 void WP_rocket (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-    Z_sound(snd[3],128);
-    wp[i].t=ROCKET;wp[i].s=(xd>=x)?1:0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,2,5,12);
-	return;
-  }
+  if((i=take(ROCKET))<0) return;
+  Z_sound(snd[3],128);
+  wp[i].s=(xd>=x)?1:0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,2,5,12);
 }
 
 void WP_revf (int x, int y, int xd, int yd, int o, int t) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-    Z_sound(snd[3],128);
-    wp[i].t=REVF;wp[i].s=(xd>=x)?1:0;
-	wp[i].own=o;wp[i].target=t;
-	throw(i,x,y,xd,yd,2,5,12);
-	return;
-  }
+  if((i=take(REVF))<0) return;
+  Z_sound(snd[3],128);
+  wp[i].s=(xd>=x)?1:0;
+  wpc[i].own=MN_ref(o);wpc[i].target=MN_ref(t);
+  throw(i,x,y,xd,yd,2,5,12);
 }
 
 void WP_plasma (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-    Z_sound(snd[5],64);
-    wp[i].t=PLASMA;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,2,5,16);
-    return;
-  }
+  if((i=take(PLASMA))<0) return;
+  Z_sound(snd[5],64);
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,2,5,16);
 }
 
 void WP_ball1 (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-	wp[i].t=BALL1;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,2,5,16);
-	return;
-  }
+  if((i=take(BALL1))<0) return;
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,2,5,16);
 }
 
 void WP_ball2 (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-	wp[i].t=BALL2;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,2,5,16);
-	return;
-  }
+  if((i=take(BALL2))<0) return;
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,2,5,16);
 }
 
 void WP_ball7 (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-	wp[i].t=BALL7;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,2,5,16);
-	return;
-  }
+  if((i=take(BALL7))<0) return;
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,2,5,16);
 }
 
 void WP_aplasma (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-	Z_sound(snd[5],64);
-	wp[i].t=APLASMA;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,2,5,16);
-	return;
-  }
+  if((i=take(APLASMA))<0) return;
+  Z_sound(snd[5],64);
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,2,5,16);
 }
 
 void WP_manfire (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-	Z_sound(snd[6],128);
-	wp[i].t=MANF;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,5,11,16);
-	return;
-  }
+  if((i=take(MANF))<0) return;
+  Z_sound(snd[6],128);
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,5,11,16);
 }
 
 void WP_bfgshot (int x, int y, int xd, int yd, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-    wp[i].t=BFGBALL;wp[i].s=0;
-	wp[i].own=o;
-	throw(i,x,y,xd,yd,5,12,16);
-	return;
-  }
+  if((i=take(BFGBALL))<0) return;
+  wp[i].s=0;
+  wpc[i].own=MN_ref(o);
+  throw(i,x,y,xd,yd,5,12,16);
 }
 
 void WP_bfghit (int x, int y, int o) {
   int i;
 
-  for(i=0;i<MAXWPN;++i) if(!wp[i].t) {
-    wp[i].t=BFGHIT;wp[i].s=0;
-    wp[i].o.x=x;wp[i].o.y=y;
-    wp[i].o.xv=wp[i].o.yv=0;
-    wp[i].o.r=0;wp[i].o.h=1;
-    wp[i].o.vx=wp[i].o.vy=0;
-    wp[i].own=o;
-    return;
-  }
+  if((i=take(BFGHIT))<0) return;
+  wp[i].s=0;
+  wp[i].o.x=x;wp[i].o.y=y;
+  wp[i].o.xv=wp[i].o.yv=0;
+  wp[i].o.r=0;wp[i].o.h=1;
+  wp[i].o.vx=wp[i].o.vy=0;
+  wpc[i].own=MN_ref(o);
 }
 
 void WP_pistol (int x,int y,int xd,int yd,int o) {
@@ -363,7 +360,7 @@ void WP_shotgun (int x, int y, int xd, int yd, int o) {
 
   Z_sound(snd[1],128);
   for(i=0;i<10;++i) {
-    j=myrand(4*2+1)-4;
+    j=RND_mod(RND_WEAPON,4*2+1)-4;
     WP_gun(x,y+j,xd,yd+j,o,i&1);
   }
 }
@@ -373,7 +370,7 @@ void WP_dshotgun (int x, int y, int xd, int yd, int o) {
 
   Z_sound(snd[2],128);
   for(i=(g_dm)?25:20;i>=0;--i) {
-    j=myrand(10*2+1)-10;
+    j=RND_mod(RND_WEAPON,10*2+1)-10;
     WP_gun(x,y+j,xd,yd+j,o,(i%3)?0:1);
   }
 }
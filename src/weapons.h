@@ -18,16 +18,19 @@
 #ifndef WEAPONS_H_INLUDED
 #define WEAPONS_H_INLUDED
 
-#define MAXWPN 300
+#include "glob.h" // POOL_SCALE
+
+#define MAXWPN (300 * POOL_SCALE)
 
 typedef struct {
   obj_t o;
   byte t, s;
-  int own;
-  short target;
 } weapon_t;
 
-extern weapon_t wp[MAXWPN];
+/* who shot it and what it homes on, read by WP_act only */
+typedef struct {
+  int own, target; // handles, see MN_ref
+} wp_cold_t;
 
 void WP_alloc (void);
 void WP_init (void);
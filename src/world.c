@@ -0,0 +1,59 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "world.h"
+#include <stdlib.h> // calloc free
+#include <string.h>
+#include <assert.h>
+#include "snap.h" // SN_free
+
+W_THREAD world_t *world;
+
+world_t *W_alloc (void) {
+  world_t *old = world;
+  world_t *w = calloc(1, sizeof(world_t));
+  if (w != NULL) {
+    // member names are macros for current world, borrow it for a moment
+    world = w;
+    g_st = GS_TITLE;
+    g_map = 1;
+    strcpy(g_music, "MENU");
+    PL_JUMP = 10;
+    PL_RUN = 8;
+    pl1.color = 0x70;
+    pl2.color = 0x60;
+    w->mn_pt_xs = 1;
+    w->mn_pt_ys = 1;
+    itm_rtime = 1092;
+    sky_type = 1;
+    fld_need_remap = 1;
+    world = old;
+  }
+  return w;
+}
+
+void W_free (world_t *w) {
+  if (w != NULL) {
+    SN_free(w);
+    if (world == w) {
+      world = NULL;
+    }
+    free(w);
+  }
+}
+
+void W_use (world_t *w) {
+  world = w;
+}
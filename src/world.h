@@ -0,0 +1,218 @@
+/* Copyright (C) 2020 SovietPony
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License ONLY.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORLD_H_INCLUDED
+#define WORLD_H_INCLUDED
+
+#include <stddef.h> // offsetof
+#include "glob.h"
+#include "view.h"
+#include "dots.h" // dot_pool_t
+#include "fx.h" // fx_t
+#include "items.h" // item_t
+#include "monster.h" // mn_t
+#include "weapons.h" // weapon_t
+#include "smoke.h" // smoke_t
+#include "switch.h" // sw_t
+#include "player.h" // player_t
+#include "game.h" // pos_t
+#include "rnd.h" // rnd_t
+#include "misc.h" // ZR__LAST ZR_WORDS z_env_t
+#include "bmap.h" // bm_rect_t
+#include "live.h" // LV_WORDS
+
+/*
+ * Everything the simulation changes lives here, so several games can run
+ * in one process. Each thread works on its own current world, set with
+ * W_use. Old global names are kept as macros below, code reads as before.
+ * Resources (sprites, sounds, random tables made by *_alloc) stay shared
+ * and must not be touched after G_init.
+ */
+
+typedef struct world_t {
+  /* game.c */
+  byte _2pl;
+  byte g_dm;
+  byte g_st;
+  byte g_exit;
+  byte g_map;
+  char g_music[8];
+  dword g_time;
+  int dm_pnum;
+  int dm_pl1p;
+  int dm_pl2p;
+  pos_t dm_pos[100];
+  int lt_time;
+  int lt_type;
+  int lt_side;
+  int lt_ypos;
+  int lt_force;
+  byte pcnt;
+  int g_trans;
+  int g_transt;
+  /* player.c */
+  byte p_immortal;
+  byte p_fly;
+  int PL_JUMP;
+  int PL_RUN;
+  int pl_aitime;
+  player_t pl1;
+  player_t pl2;
+  /* monster.c */
+  int hit_xv, hit_yv;
+  int mnum, gsndt;
+  int mn_pt_x, mn_pt_xs, mn_pt_y, mn_pt_ys;
+  mn_t mn[MAXMN];
+  mn_cold_t mnc[MAXMN];
+  uint64_t mn_live[LV_WORDS(MAXMN)];
+  word mn_gen[MAXMN]; // spawns into the slot, see MN_ref
+  /* items.c */
+  int itm_rtime;
+  int it_tsndtm, it_rsndtm;
+  item_t it[MAXITEM];
+  uint64_t it_live[LV_WORDS(MAXITEM)];
+  /* weapons.c */
+  weapon_t wp[MAXWPN];
+  wp_cold_t wpc[MAXWPN];
+  uint64_t wp_live[LV_WORDS(MAXWPN)];
+  /* dots.c */
+  int dot_bl_r, dot_sp_r, dot_sr_r;
+  int dot_last;
+  dot_pool_t dot;
+  uint64_t dot_live[LV_WORDS(MAXDOT)];
+  /* smoke.c */
+  int sm_sr_r;
+  int sm_last;
+  int sm_burntm;
+  smoke_t sm[MAXSMOK];
+  uint64_t sm_live[LV_WORDS(MAXSMOK)];
+  /* fx.c */
+  char fx_bubsn;
+  int fx_last;
+  fx_t fx[MAXFX];
+  uint64_t fx_live[LV_WORDS(MAXFX)];
+  /* switch.c */
+  int sw_secrets;
+  int sw_swsnd;
+  sw_t sw[MAXSW];
+  uint64_t sw_live[LV_WORDS(MAXSW)];
+  /* rnd.c */
+  rnd_t rnd[RND__LAST];
+  /* view.c, bmap.c */
+  int sky_type;
+  dword walf[256];
+  byte fld_need_remap;
+  byte bm_x0, bm_y0, bm_x1, bm_y1; // fld changed there if fld_need_remap
+  byte bmap[FLDH/4][FLDW/4];
+  word bm_mon[FLDH/4][FLDW/4]; // monster marks covering the cell
+  bm_rect_t bm_mn[MAXMN][2]; // monster marks: at last BM_sync, by BM_moved
+  bm_rect_t bm_pl[2];
+  /* map fields, snapshots keep them apart, see snap.c */
+  byte fld[FLDH][FLDW];
+  byte fldb[FLDH][FLDW];
+  byte fldf[FLDH][FLDW];
+  /* not part of the game state */
+  word fldt[FLDH][FLDW]; // ZT_* flags of fld cells, see Z_retile
+  uint64_t fldr[ZR__LAST][FLDH][ZR_WORDS]; // same as row bitsets
+  byte flds[FLDH][FLDW]; // cells to the nearest ZT_SOLID, up to ZS_FAR
+  byte fldo[FLDH][FLDW]; // to the nearest ZO_MASK, up to ZO_FAR
+  z_seen_t z_seen[ZS_SEEN]; // Z_cansee results while walls stay put
+  dword z_seegen;
+  dword z_envgen; // bumped with every fldt change
+  z_env_t pl_env[2], mn_env[MAXMN], it_env[MAXITEM], wp_env[MAXWPN]; // Z_moveobj
+  z_env_t dot_env[MAXDOT];
+  dot_stay_t dot_stay[MAXDOT]; // at dot_env x, y
+  int z_traps; // ZT_TRAP cells
+  byte z_tx0, z_ty0, z_tx1, z_ty1; // around them
+  uint64_t bm_grid[FLDH/4][FLDW/4][BM_MNW]; // monsters in bmap cells
+  bm_rect_t bm_cell[MAXMN]; // their cells in bm_grid
+  byte dot_st[MAXDOT]; // DOT_move to DOT_settle: Z_moveobj result
+  int dot_xv[MAXDOT], dot_yv[MAXDOT]; // speed before the move
+  byte sm_moved[MAXSMOK]; // SMK_move to SMK_settle: moved, burn pending
+  byte z_sndhold; // Z_holdsnd to Z_flushsnd
+  int z_sndn;
+  z_snd_t z_snd[Z_SNDQ]; // sounds of this tick, first asked first
+  struct snap_ctx_t *snap; // snap.c, NULL if no history kept
+} world_t;
+
+/* game state ends where map fields begin, member names are taken below */
+enum { W_STATE = offsetof(world_t, fld) };
+
+extern W_THREAD world_t *world;
+
+world_t *W_alloc (void);
+void W_free (world_t *w);
+void W_use (world_t *w);
+
+#define _2pl (world->_2pl)
+#define g_dm (world->g_dm)
+#define g_st (world->g_st)
+#define g_exit (world->g_exit)
+#define g_map (world->g_map)
+#define g_music (world->g_music)
+#define g_time (world->g_time)
+#define dm_pnum (world->dm_pnum)
+#define dm_pl1p (world->dm_pl1p)
+#define dm_pl2p (world->dm_pl2p)
+#define dm_pos (world->dm_pos)
+#define lt_time (world->lt_time)
+#define lt_type (world->lt_type)
+#define lt_side (world->lt_side)
+#define lt_ypos (world->lt_ypos)
+#define g_trans (world->g_trans)
+#define p_immortal (world->p_immortal)
+#define p_fly (world->p_fly)
+#define PL_JUMP (world->PL_JUMP)
+#define PL_RUN (world->PL_RUN)
+#define pl1 (world->pl1)
+#define pl2 (world->pl2)
+#define hit_xv (world->hit_xv)
+#define hit_yv (world->hit_yv)
+#define mnum (world->mnum)
+#define gsndt (world->gsndt)
+#define mn (world->mn)
+#define mnc (world->mnc)
+#define mn_live (world->mn_live)
+#define mn_gen (world->mn_gen)
+#define itm_rtime (world->itm_rtime)
+#define it (world->it)
+#define it_live (world->it_live)
+#define wp (world->wp)
+#define wpc (world->wpc)
+#define wp_live (world->wp_live)
+#define dot (world->dot)
+#define dot_live (world->dot_live)
+#define sm (world->sm)
+#define sm_live (world->sm_live)
+#define fx (world->fx)
+#define fx_live (world->fx_live)
+#define sw_secrets (world->sw_secrets)
+#define sw (world->sw)
+#define sw_live (world->sw_live)
+#define rnd (world->rnd)
+#define sky_type (world->sky_type)
+#define walf (world->walf)
+#define fld_need_remap (world->fld_need_remap)
+#define bmap (world->bmap)
+#define bm_mon (world->bm_mon)
+#define fld (world->fld)
+#define fldb (world->fldb)
+#define fldf (world->fldf)
+#define fldt (world->fldt)
+#define fldr (world->fldr)
+#define flds (world->flds)
+#define fldo (world->fldo)
+
+#endif /* WORLD_H_INCLUDED */